@@ -0,0 +1,126 @@
+#include "bench.h"
+#include <atomic>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <new>
+
+static std::atomic<uint64_t> allocCount(0);
+static std::atomic<uint64_t> allocBytes(0);
+
+static void countAlloc(size_t size) {
+    allocCount.fetch_add(1, std::memory_order_relaxed);
+    allocBytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+#ifdef __GLIBC__
+// glibc: malloc selbst ersetzen, dann zählen auch ArduinoJson, ingestBodyCreate()
+// und operator new (ruft malloc) mit
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+
+void *malloc(size_t size) {
+    countAlloc(size);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) {
+    countAlloc(count * size);
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size) {
+    countAlloc(size);
+    return __libc_realloc(ptr, size);
+}
+}
+#else
+// Sonst nur operator new; malloc()-Aufrufe fehlen dann in der Statistik
+void *operator new(size_t size) {
+    countAlloc(size);
+    void *ptr = malloc(size);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void *operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void *ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void *ptr, size_t) noexcept {
+    free(ptr);
+}
+#endif
+
+uint64_t benchAllocCount() {
+    return allocCount.load(std::memory_order_relaxed);
+}
+
+uint64_t benchAllocBytes() {
+    return allocBytes.load(std::memory_order_relaxed);
+}
+
+BenchResult benchRun(const BenchCase &bench) {
+    BenchResult result = {};
+
+    // Einmal vorweg: Dateien im Page-Cache, Puffer angelegt
+    bench.run(1);
+
+    for (uint64_t iterations = 1;; iterations *= 2) {
+        uint64_t allocsBefore = benchAllocCount();
+        uint64_t bytesBefore = benchAllocBytes();
+        auto start = std::chrono::steady_clock::now();
+
+        bench.run(iterations);
+
+        auto stop = std::chrono::steady_clock::now();
+        result.iterations = iterations;
+        result.seconds = std::chrono::duration<double>(stop - start).count();
+        result.allocs = benchAllocCount() - allocsBefore;
+        result.allocBytes = benchAllocBytes() - bytesBefore;
+
+        if (result.seconds >= BENCH_MIN_SECONDS) return result;
+    }
+}
+
+void benchPrintHeader() {
+    printf("%-24s %10s %12s %16s %11s %11s\n",
+           "benchmark", "iter", "ns/op", "throughput", "allocs/op", "bytes/op");
+}
+
+void benchPrint(const BenchCase &bench, const BenchResult &result) {
+    double perOp = result.seconds / result.iterations;
+    double items = bench.items ? bench.items() : 1.0;
+    double throughput = items / perOp;
+
+    char rate[32];
+    if (throughput >= 1e6) {
+        snprintf(rate, sizeof(rate), "%.2f M%s/s", throughput / 1e6, bench.unit);
+    } else if (throughput >= 1e3) {
+        snprintf(rate, sizeof(rate), "%.2f k%s/s", throughput / 1e3, bench.unit);
+    } else {
+        snprintf(rate, sizeof(rate), "%.2f %s/s", throughput, bench.unit);
+    }
+
+    printf("%-24s %10llu %12.0f %16s %11.1f %11.0f\n",
+           bench.name,
+           (unsigned long long)result.iterations,
+           perOp * 1e9,
+           rate,
+           (double)result.allocs / result.iterations,
+           (double)result.allocBytes / result.iterations);
+}
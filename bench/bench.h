@@ -0,0 +1,46 @@
+// bench.h - Kleiner Mikrobenchmark-Rahmen für die native-Umgebung
+//
+// Ein Fall führt pro Aufruf von run() eine Operation aus (z.B. einen Batch
+// übernehmen oder eine /sd-data-Antwort komplett erzeugen). benchRun() erhöht
+// die Wiederholungen, bis BENCH_MIN_SECONDS erreicht sind, und misst dabei
+// Zeit sowie malloc()-Aufrufe und angeforderte Bytes. items gibt an, wie viele
+// Einheiten (Datensätze, Messungen, Byte) eine Operation verarbeitet, daraus
+// wird der Durchsatz.
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define BENCH_MIN_SECONDS 0.5
+
+struct BenchCase {
+    const char *name;           // "gruppe/fall", für den Filter auf der Kommandozeile
+    const char *unit;           // Einheit von items, z.B. "rec" oder "B"
+    void (*run)(uint64_t iterations);
+    double (*items)();          // Einheiten pro Operation, nullptr = 1
+};
+
+struct BenchResult {
+    uint64_t iterations;
+    double seconds;
+    uint64_t allocs;
+    uint64_t allocBytes;
+};
+
+// Allokationszähler seit Programmstart
+uint64_t benchAllocCount();
+uint64_t benchAllocBytes();
+
+BenchResult benchRun(const BenchCase &bench);
+
+void benchPrintHeader();
+void benchPrint(const BenchCase &bench, const BenchResult &result);
+
+// Verhindert, dass der Compiler ein unbenutztes Ergebnis wegoptimiert
+template <typename T>
+inline void benchKeep(const T &value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+#endif
@@ -0,0 +1,302 @@
+// main.cpp (bench) - Mikrobenchmarks für Log, /sd-data, JSON und Ingest
+//
+//   pio run -e native && .pio/build/native/program [filter]
+//
+// Legt unter /tmp eine SD-Karte mit BENCH_LOG_RECORDS Datensätzen von
+// BENCH_NODES Nodes an (Rollups inklusive) und misst dann jeden Fall, dessen
+// Name filter enthält. Ausgabe auf stdout, Meldungen der Module (Serial) auf
+// stderr. Vor und nach einer Änderung laufen lassen und die Tabellen
+// vergleichen; allocs/op und bytes/op sind unabhängig von der Maschine.
+#include <Arduino.h>
+#include <SD.h>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include "bench.h"
+#include "sensor_log.h"
+#include "sample_ring.h"
+#include "rollup.h"
+#include "node_registry.h"
+#include "history_query.h"
+#include "history_stream.h"
+#include "ingest.h"
+#include "sensors_json.h"
+
+#define BENCH_NODES         4
+#define BENCH_LOG_RECORDS   20000
+#define BENCH_LOG_START     1735689600UL    // 2025-01-01
+#define BENCH_LOG_STEP      15              // Sekunden zwischen zwei Datensätzen (alle Nodes)
+#define BENCH_BATCH_SAMPLES 50
+#define BENCH_CHUNK         1436            // so viel füllt AsyncTCP pro Segment
+
+static uint8_t benchNodes[BENCH_NODES];
+static uint32_t nextTimestamp = BENCH_LOG_START;
+
+static std::string ndjsonBody;
+static std::string arrayBody;
+static size_t lastResponseBytes = 0;
+
+static SensorRecord makeRecord(uint8_t node, uint32_t timestamp) {
+    SensorRecord record;
+    memset(&record, 0, sizeof(record));
+    record.timestamp = timestamp;
+    record.node = node;
+    record.valid = 0x07;
+    record.values[0] = 20.0f + (timestamp % 600) / 100.0f;
+    record.values[1] = 40.0f + (timestamp % 900) / 50.0f;
+    record.values[2] = 1013.25f - (timestamp % 300) / 30.0f;
+    return record;
+}
+
+static void appendRecords(uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        sensorLogAppend(makeRecord(benchNodes[i % BENCH_NODES], nextTimestamp));
+        nextTimestamp += BENCH_LOG_STEP;
+    }
+    sensorLogFlush();
+}
+
+// --- Log: Datensätze schreiben (Journal + Datei) und blockweise lesen ---
+
+static void benchLogAppend(uint64_t iterations) {
+    for (uint64_t i = 0; i < iterations; i++) {
+        sensorLogAppend(makeRecord(benchNodes[i % BENCH_NODES], nextTimestamp));
+        nextTimestamp += BENCH_LOG_STEP;
+    }
+}
+
+static void benchLogRead(uint64_t iterations) {
+    SensorRecord block[RECORD_SOURCE_BLOCK_RECORDS];
+
+    for (uint64_t i = 0; i < iterations; i++) {
+        uint32_t total = sensorLogCount();
+        for (uint32_t index = sensorLogFirstIndex(); index < total;) {
+            size_t count = sensorLogReadRange(index, block, RECORD_SOURCE_BLOCK_RECORDS);
+            if (count == 0) break;
+            benchKeep(block[0]);
+            index += count;
+        }
+    }
+}
+
+static double logRecords() {
+    return BENCH_LOG_RECORDS;
+}
+
+static void benchLogLowerBound(uint64_t iterations) {
+    uint32_t span = BENCH_LOG_RECORDS * BENCH_LOG_STEP;
+
+    for (uint64_t i = 0; i < iterations; i++) {
+        uint32_t t = BENCH_LOG_START + (uint32_t)((i * 7919) % span);
+        benchKeep(sensorLogLowerBound(t));
+    }
+}
+
+// --- /sd-data: Abfrage planen und die Antwort komplett erzeugen ---
+
+static void streamQuery(const HistoryQuery &query, uint64_t iterations) {
+    uint8_t chunk[BENCH_CHUNK];
+
+    for (uint64_t i = 0; i < iterations; i++) {
+        HistoryStream stream(historyOpen(query), query.node);
+
+        size_t total = 0;
+        size_t len;
+        while ((len = stream.read(chunk, sizeof(chunk))) > 0) total += len;
+        lastResponseBytes = total;
+    }
+}
+
+static void benchSdDataTail(uint64_t iterations) {
+    HistoryQuery query;
+    historyQueryInit(query);
+    query.node = benchNodes[1];
+    streamQuery(query, iterations);
+}
+
+static void benchSdDataDay(uint64_t iterations) {
+    HistoryQuery query;
+    historyQueryInit(query);
+    query.node = benchNodes[1];
+    query.from = BENCH_LOG_START + 86400;
+    query.to = BENCH_LOG_START + 2 * 86400 - 1;
+    streamQuery(query, iterations);
+}
+
+static void benchSdDataLttb(uint64_t iterations) {
+    HistoryQuery query;
+    historyQueryInit(query);
+    query.node = benchNodes[1];
+    query.from = BENCH_LOG_START;
+    query.to = BENCH_LOG_START + BENCH_LOG_RECORDS * BENCH_LOG_STEP;
+    query.points = HISTORY_DEFAULT_POINTS;
+    query.agg = AGG_LTTB;
+    streamQuery(query, iterations);
+}
+
+static double responseBytes() {
+    return lastResponseBytes;
+}
+
+// --- JSON: /sensors aufbauen und serialisieren ---
+
+static WeatherState benchWeather() {
+    WeatherState weather;
+    memset(&weather, 0, sizeof(weather));
+    strcpy(weather.description, "12C, leichter Regen");
+    weather.fetchedAt = BENCH_LOG_START;
+    return weather;
+}
+
+// Ohne Cache: Snapshot und Serialisierung bei jeder Anfrage
+static void benchSensorsJson(uint64_t iterations) {
+    static NodeInfo nodes[NODE_MAX];
+    static char output[4096];
+    WeatherState weather = benchWeather();
+
+    for (uint64_t i = 0; i < iterations; i++) {
+        uint8_t total;
+        uint32_t version = nodeSnapshot(nodes, total);
+
+        JsonWriter json(output, sizeof(output));
+        sensorsJsonWrite(json, weather, nodes, total, version);
+        lastResponseBytes = json.length();
+    }
+}
+
+// Wie /sensors: neu gebaut wird nur nach einer Änderung
+static void benchSensorsCached(uint64_t iterations) {
+    WeatherState weather = benchWeather();
+
+    for (uint64_t i = 0; i < iterations; i++) {
+        std::shared_ptr<const SensorsBody> body = sensorsJsonCurrent(weather);
+        lastResponseBytes = body ? body->length : 0;
+    }
+}
+
+// --- Ingest: POST-Body parsen, prüfen und einreihen ---
+
+static void buildBodies() {
+    for (int i = 0; i < BENCH_BATCH_SAMPLES; i++) {
+        char line[96];
+        snprintf(line, sizeof(line), "{\"temperature\":%.2f,\"humidity\":%.1f,\"pressure\":%.2f}",
+                 20.0 + i / 10.0, 40.0 + i / 5.0, 1013.25 - i / 20.0);
+
+        ndjsonBody += line;
+        ndjsonBody += "\n";
+        arrayBody += i ? "," : "[";
+        arrayBody += line;
+    }
+    arrayBody += "]";
+}
+
+static void ingestBody(const std::string &body, uint64_t iterations) {
+    SensorRecord record;
+
+    for (uint64_t i = 0; i < iterations; i++) {
+        IngestAck ack;
+        ingestBatch(benchNodes[2], body.data(), body.size(), ack);
+
+        // Wie der ingest-Task: Warteschlange leeren, sonst wird sie voll
+        while (ingestNextPending(record)) benchKeep(record);
+    }
+}
+
+static void benchIngestNdjson(uint64_t iterations) {
+    ingestBody(ndjsonBody, iterations);
+}
+
+static void benchIngestArray(uint64_t iterations) {
+    ingestBody(arrayBody, iterations);
+}
+
+static double batchSamples() {
+    return BENCH_BATCH_SAMPLES;
+}
+
+// Reihenfolge zählt: log/append verlängert das Log und läuft deshalb zuletzt
+static const BenchCase benchCases[] = {
+    { "log/read",           "rec",   benchLogRead,       logRecords },
+    { "log/lower_bound",    "op",    benchLogLowerBound, nullptr },
+    { "sd_data/tail",       "B",     benchSdDataTail,    responseBytes },
+    { "sd_data/day_raw",    "B",     benchSdDataDay,     responseBytes },
+    { "sd_data/all_lttb",   "B",     benchSdDataLttb,    responseBytes },
+    { "json/sensors",       "B",     benchSensorsJson,   responseBytes },
+    { "json/sensors_hit",   "B",     benchSensorsCached, responseBytes },
+    { "ingest/ndjson",      "smp",   benchIngestNdjson,  batchSamples },
+    { "ingest/array",       "smp",   benchIngestArray,   batchSamples },
+    { "log/append",         "rec",   benchLogAppend,     nullptr },
+};
+
+// Bytes aller Log-Partitionen auf der Karte
+static uintmax_t logBytes(const char *root) {
+    uintmax_t total = 0;
+    for (const auto &entry : std::filesystem::recursive_directory_iterator(std::string(root) + SENSOR_LOG_DIR)) {
+        if (entry.is_regular_file() && entry.path().filename() != "manifest.bin") total += entry.file_size();
+    }
+    return total;
+}
+
+static bool setupCard(const char *root) {
+    SD.setRoot(root);
+    if (!SD.begin()) return false;
+
+    nodeRegistryBegin(SD);
+    for (int i = 0; i < BENCH_NODES; i++) {
+        char id[NODE_ID_LEN];
+        snprintf(id, sizeof(id), "bench%d", i);
+
+        int node = i == 0 ? NODE_LOCAL : nodeRegister(id);
+        if (node < 0) return false;
+        benchNodes[i] = node;
+
+        nodeChannelSlot(node, KIND_TEMPERATURE, true);
+        nodeChannelSlot(node, KIND_HUMIDITY, true);
+        nodeChannelSlot(node, KIND_PRESSURE, true);
+        nodeUpdate(makeRecord(node, BENCH_LOG_START));
+    }
+    nodeRegistryFlush(false);
+
+    if (!sensorLogBegin(SD)) return false;
+    appendRecords(BENCH_LOG_RECORDS);
+
+    // Wie der storage-Task im Leerlauf: abgeschlossene Tage komprimieren
+    uintmax_t raw = logBytes(root);
+    while (sensorLogCompact()) {}
+    printf("Log: %ju Bytes roh, %ju Bytes komprimiert\n", raw, logBytes(root));
+
+    sampleRingBegin();
+    rollupBegin(SD);
+    ingestBegin();
+    return true;
+}
+
+int main(int argc, char **argv) {
+    const char *filter = argc > 1 ? argv[1] : "";
+
+    char root[] = "/tmp/homeserver-bench-XXXXXX";
+    if (!mkdtemp(root)) {
+        perror("mkdtemp");
+        return 1;
+    }
+
+    if (!setupCard(root)) {
+        fprintf(stderr, "Testkarte unter %s ließ sich nicht anlegen\n", root);
+        return 1;
+    }
+    buildBodies();
+
+    printf("%d Datensätze, %d Nodes, Karte unter %s\n\n", BENCH_LOG_RECORDS, BENCH_NODES, root);
+    benchPrintHeader();
+
+    for (const BenchCase &bench : benchCases) {
+        if (!strstr(bench.name, filter)) continue;
+
+        BenchResult result = benchRun(bench);
+        benchPrint(bench, result);
+        fflush(stdout);
+    }
+
+    std::filesystem::remove_all(root);
+    return 0;
+}
@@ -0,0 +1,28 @@
+// Adafruit_BMP280.h (native) - BMP280 mit festen, setzbaren Werten
+#ifndef HAL_NATIVE_ADAFRUIT_BMP280_H
+#define HAL_NATIVE_ADAFRUIT_BMP280_H
+
+#include "Arduino.h"
+#include "Wire.h"
+
+class Adafruit_BMP280 {
+public:
+    Adafruit_BMP280(TwoWire *wire = &Wire) {}
+
+    bool begin(uint8_t address = 0x77) { return true; }
+
+    float readTemperature() { return temperature; }
+    float readPressure() { return pressure; }
+
+    // Werte der folgenden Messungen, Druck in Pa
+    void set(float temperature, float pressure) {
+        this->temperature = temperature;
+        this->pressure = pressure;
+    }
+
+private:
+    float temperature = 21.5f;
+    float pressure = 101325.0f;
+};
+
+#endif
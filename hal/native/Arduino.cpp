@@ -0,0 +1,178 @@
+#include "Arduino.h"
+#include <chrono>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+
+HardwareSerial Serial;
+
+static const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+unsigned long millis() {
+    return (unsigned long)std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - startTime).count();
+}
+
+unsigned long micros() {
+    return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - startTime).count();
+}
+
+void delay(unsigned long ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void yield() {
+    std::this_thread::yield();
+}
+
+size_t Print::write(const uint8_t *buffer, size_t size) {
+    size_t n = 0;
+    while (n < size && write(buffer[n])) n++;
+    return n;
+}
+
+size_t Print::print(long value) {
+    char text[24];
+    int len = snprintf(text, sizeof(text), "%ld", value);
+    return write((const uint8_t *)text, len);
+}
+
+size_t Print::print(unsigned long value) {
+    char text[24];
+    int len = snprintf(text, sizeof(text), "%lu", value);
+    return write((const uint8_t *)text, len);
+}
+
+size_t Print::print(double value, int digits) {
+    char text[48];
+    int len = snprintf(text, sizeof(text), "%.*f", digits, value);
+    return write((const uint8_t *)text, len);
+}
+
+// Wie auf dem ESP32: 64 Byte auf dem Stack, längere Ausgaben über malloc()
+size_t Print::printf(const char *format, ...) {
+    char stackBuffer[64];
+    char *text = stackBuffer;
+
+    va_list args;
+    va_start(args, format);
+    va_list copy;
+    va_copy(copy, args);
+    int len = vsnprintf(text, sizeof(stackBuffer), format, copy);
+    va_end(copy);
+
+    if (len < 0) {
+        va_end(args);
+        return 0;
+    }
+    if ((size_t)len >= sizeof(stackBuffer)) {
+        text = (char *)malloc(len + 1);
+        if (!text) {
+            va_end(args);
+            return 0;
+        }
+        vsnprintf(text, len + 1, format, args);
+    }
+    va_end(args);
+
+    size_t written = write((const uint8_t *)text, len);
+    if (text != stackBuffer) free(text);
+    return written;
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+    return fputc(c, stderr) == EOF ? 0 : 1;
+}
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size) {
+    return fwrite(buffer, 1, size, stderr);
+}
+
+bool psramFound() {
+    return false;
+}
+
+void *ps_malloc(size_t size) {
+    return malloc(size);
+}
+
+// Ringpuffer fester Größe, angelegt bei xQueueCreate() - Senden und Empfangen
+// allokieren wie auf dem ESP32 nicht. Ein Mutex ist wie bei FreeRTOS eine
+// Queue mit einem Platz ohne Nutzdaten, die "voll" startet.
+struct NativeQueue {
+    size_t length;
+    size_t itemSize;
+    std::vector<uint8_t> storage;
+    size_t head;
+    size_t count;
+    std::mutex lock;
+    std::condition_variable changed;
+};
+
+static bool waitFor(NativeQueue *queue, std::unique_lock<std::mutex> &guard, TickType_t wait, bool (*ready)(NativeQueue *)) {
+    if (wait == portMAX_DELAY) {
+        queue->changed.wait(guard, [queue, ready] { return ready(queue); });
+        return true;
+    }
+    return queue->changed.wait_for(guard, std::chrono::milliseconds(wait), [queue, ready] { return ready(queue); });
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+    NativeQueue *queue = new NativeQueue;
+    queue->length = length;
+    queue->itemSize = itemSize;
+    queue->storage.resize(length * itemSize);
+    queue->head = 0;
+    queue->count = 0;
+    return queue;
+}
+
+void vQueueDelete(QueueHandle_t queue) {
+    delete queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t wait) {
+    std::unique_lock<std::mutex> guard(queue->lock);
+    if (!waitFor(queue, guard, wait, [](NativeQueue *q) { return q->count < q->length; })) return pdFALSE;
+
+    size_t slot = (queue->head + queue->count) % queue->length;
+    if (queue->itemSize) memcpy(&queue->storage[slot * queue->itemSize], item, queue->itemSize);
+    queue->count++;
+    queue->changed.notify_all();
+    return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t wait) {
+    std::unique_lock<std::mutex> guard(queue->lock);
+    if (!waitFor(queue, guard, wait, [](NativeQueue *q) { return q->count > 0; })) return pdFALSE;
+
+    if (queue->itemSize) memcpy(item, &queue->storage[queue->head * queue->itemSize], queue->itemSize);
+    queue->head = (queue->head + 1) % queue->length;
+    queue->count--;
+    queue->changed.notify_all();
+    return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+    std::lock_guard<std::mutex> guard(queue->lock);
+    return queue->count;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex() {
+    QueueHandle_t queue = xQueueCreate(1, 0);
+    xQueueSend(queue, nullptr, 0);
+    return queue;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t wait) {
+    return xQueueReceive(semaphore, nullptr, wait);
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+    return xQueueSend(semaphore, nullptr, 0);
+}
+
+void vTaskDelay(TickType_t ticks) {
+    delay(ticks * portTICK_PERIOD_MS);
+}
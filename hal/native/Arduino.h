@@ -0,0 +1,114 @@
+// Arduino.h (native) - Schmale Nachbildung der Arduino-/ESP32-API für den Host
+//
+// Nur für die Umgebung "native" in platformio.ini: damit laufen Log, Ingest,
+// History und JSON-Aufbau ohne ESP32 unter Linux (bench/). Enthalten ist
+// genau das, was diese Module benutzen:
+//
+//   Zeit       millis(), micros(), delay(); time() ist die Host-Uhr
+//   Serial     schreibt nach stderr, stdout bleibt den Benchmark-Ergebnissen
+//   Speicher   psramFound() = false, ps_malloc() = malloc()
+//   FreeRTOS   Queues, Mutexe und portMUX mit std::mutex; Tasks gibt es nicht
+//
+// Blockierende Aufrufe (xQueueReceive mit Wartezeit) warten wirklich, damit
+// sich Module mit std::thread auch nebenläufig ausprobieren lassen.
+#ifndef HAL_NATIVE_ARDUINO_H
+#define HAL_NATIVE_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include <time.h>
+#include <mutex>
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void yield();
+
+class Print {
+public:
+    virtual ~Print() {}
+
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size);
+
+    size_t write(const char *str) { return write((const uint8_t *)str, strlen(str)); }
+
+    size_t print(const char *str) { return write(str); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(long value);
+    size_t print(unsigned long value);
+    size_t print(int value) { return print((long)value); }
+    size_t print(unsigned int value) { return print((unsigned long)value); }
+    size_t print(double value, int digits = 2);
+
+    size_t println() { return print("\n"); }
+    template <typename T> size_t println(T value) { size_t n = print(value); return n + println(); }
+
+    size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+class HardwareSerial : public Print {
+public:
+    void begin(unsigned long baud) {}
+
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t *buffer, size_t size) override;
+    using Print::write;
+};
+
+extern HardwareSerial Serial;
+
+// ESP32: PSRAM gibt es auf dem Host nicht, Puffer landen im Heap
+bool psramFound();
+void *ps_malloc(size_t size);
+
+// --- FreeRTOS (Teilmenge) ---
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdTRUE              1
+#define pdFALSE             0
+#define pdPASS              pdTRUE
+#define portMAX_DELAY       ((TickType_t)0xFFFFFFFF)
+#define portTICK_PERIOD_MS  1
+#define pdMS_TO_TICKS(ms)   ((TickType_t)(ms))
+
+struct NativeQueue;
+struct NativeTask;
+typedef NativeQueue *QueueHandle_t;
+typedef NativeQueue *SemaphoreHandle_t;
+typedef NativeTask *TaskHandle_t;
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize);
+void vQueueDelete(QueueHandle_t queue);
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t wait);
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t wait);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue);
+
+SemaphoreHandle_t xSemaphoreCreateMutex();
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t wait);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore);
+
+void vTaskDelay(TickType_t ticks);
+
+// Spinlock der ESP32-Kerne (auf demselben Kern verschachtelbar); auf dem Host
+// reicht ein rekursiver Mutex
+struct portMUX_TYPE {
+    std::recursive_mutex lock;
+};
+#define portMUX_INITIALIZER_UNLOCKED {}
+#define portENTER_CRITICAL(mux) (mux)->lock.lock()
+#define portEXIT_CRITICAL(mux)  (mux)->lock.unlock()
+
+#endif
@@ -0,0 +1,107 @@
+#include "FS.h"
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs {
+
+File::File(FILE *handle, const std::string &path)
+    : handle(handle, fclose), filePath(path) {
+}
+
+size_t File::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t File::write(const uint8_t *buffer, size_t size) {
+    return handle ? fwrite(buffer, 1, size, handle.get()) : 0;
+}
+
+int File::available() {
+    if (!handle) return 0;
+    size_t pos = position();
+    size_t total = size();
+    return total > pos ? (int)(total - pos) : 0;
+}
+
+int File::read() {
+    return handle ? fgetc(handle.get()) : -1;
+}
+
+size_t File::read(uint8_t *buffer, size_t size) {
+    return handle ? fread(buffer, 1, size, handle.get()) : 0;
+}
+
+size_t File::readBytesUntil(char terminator, char *buffer, size_t length) {
+    size_t n = 0;
+    while (n < length) {
+        int c = read();
+        if (c < 0 || c == terminator) break;
+        buffer[n++] = (char)c;
+    }
+    return n;
+}
+
+void File::flush() {
+    if (handle) fflush(handle.get());
+}
+
+bool File::seek(uint32_t pos, SeekMode mode) {
+    return handle && fseek(handle.get(), pos, mode == SeekSet ? SEEK_SET : (mode == SeekCur ? SEEK_CUR : SEEK_END)) == 0;
+}
+
+size_t File::position() const {
+    return handle ? ftell(handle.get()) : 0;
+}
+
+size_t File::size() const {
+    if (!handle) return 0;
+
+    // fstat sieht gepufferte Schreibzugriffe erst nach fflush
+    fflush(handle.get());
+    struct stat info;
+    return fstat(fileno(handle.get()), &info) == 0 ? info.st_size : 0;
+}
+
+void File::close() {
+    handle.reset();
+}
+
+const char *File::name() const {
+    size_t slash = filePath.rfind('/');
+    return filePath.c_str() + (slash == std::string::npos ? 0 : slash + 1);
+}
+
+FS::FS(const char *root) : root(root) {
+}
+
+std::string FS::hostPath(const char *path) const {
+    return root + (path[0] == '/' ? "" : "/") + path;
+}
+
+File FS::open(const char *path, const char *mode, bool create) {
+    FILE *handle = fopen(hostPath(path).c_str(), mode);
+    return handle ? File(handle, path) : File();
+}
+
+bool FS::exists(const char *path) {
+    struct stat info;
+    return stat(hostPath(path).c_str(), &info) == 0;
+}
+
+bool FS::remove(const char *path) {
+    return ::remove(hostPath(path).c_str()) == 0;
+}
+
+bool FS::rename(const char *from, const char *to) {
+    return ::rename(hostPath(from).c_str(), hostPath(to).c_str()) == 0;
+}
+
+bool FS::mkdir(const char *path) {
+    return ::mkdir(hostPath(path).c_str(), 0755) == 0;
+}
+
+bool FS::rmdir(const char *path) {
+    return ::rmdir(hostPath(path).c_str()) == 0;
+}
+
+}
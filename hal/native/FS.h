@@ -0,0 +1,80 @@
+// FS.h (native) - Dateisystem der ESP32-Arduino-Umgebung über stdio
+//
+// Ein fs::FS bildet seine Pfade unter ein Verzeichnis des Hosts ab
+// ("/sensor_log.bin" -> "<root>/sensor_log.bin"). File verhält sich wie auf
+// dem ESP32: Kopien teilen sich die offene Datei, close() oder die letzte
+// Kopie schließt sie. Die Modi sind die von fopen() ("r", "w", "a", "r+").
+#ifndef HAL_NATIVE_FS_H
+#define HAL_NATIVE_FS_H
+
+#include "Arduino.h"
+#include <memory>
+#include <string>
+
+#define FILE_READ   "r"
+#define FILE_WRITE  "w"
+#define FILE_APPEND "a"
+
+namespace fs {
+
+enum SeekMode {
+    SeekSet = 0,
+    SeekCur = 1,
+    SeekEnd = 2
+};
+
+class File : public Print {
+public:
+    File() {}
+    File(FILE *handle, const std::string &path);
+
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t *buffer, size_t size) override;
+    using Print::write;
+
+    int available();
+    int read();
+    size_t read(uint8_t *buffer, size_t size);
+    size_t readBytesUntil(char terminator, char *buffer, size_t length);
+
+    void flush();
+    bool seek(uint32_t pos, SeekMode mode = SeekSet);
+    size_t position() const;
+    size_t size() const;
+    void close();
+
+    operator bool() const { return handle != nullptr; }
+    const char *path() const { return filePath.c_str(); }
+    const char *name() const;
+
+private:
+    std::shared_ptr<FILE> handle;
+    std::string filePath;
+};
+
+class FS {
+public:
+    explicit FS(const char *root = ".");
+
+    void setRoot(const char *root) { this->root = root; }
+    const char *rootPath() const { return root.c_str(); }
+
+    File open(const char *path, const char *mode = FILE_READ, bool create = false);
+    bool exists(const char *path);
+    bool remove(const char *path);
+    bool rename(const char *from, const char *to);
+    bool mkdir(const char *path);
+    bool rmdir(const char *path);
+
+protected:
+    std::string hostPath(const char *path) const;
+
+    std::string root;
+};
+
+}
+
+using fs::FS;
+using fs::File;
+
+#endif
@@ -0,0 +1,13 @@
+#include "SD.h"
+#include <sys/stat.h>
+
+SDFS SD;
+
+SDFS::SDFS() : fs::FS(getenv("HOMESERVER_SD_ROOT") ? getenv("HOMESERVER_SD_ROOT") : "./sd") {
+}
+
+bool SDFS::begin() {
+    struct stat info;
+    if (stat(root.c_str(), &info) == 0) return S_ISDIR(info.st_mode);
+    return ::mkdir(root.c_str(), 0755) == 0;
+}
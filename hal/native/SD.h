@@ -0,0 +1,20 @@
+// SD.h (native) - SD-Karte als Verzeichnis des Hosts
+//
+// Wurzel ist $HOMESERVER_SD_ROOT, sonst "./sd". begin() legt das Verzeichnis
+// bei Bedarf an.
+#ifndef HAL_NATIVE_SD_H
+#define HAL_NATIVE_SD_H
+
+#include "FS.h"
+
+class SDFS : public fs::FS {
+public:
+    SDFS();
+
+    bool begin();
+    void end() {}
+};
+
+extern SDFS SD;
+
+#endif
@@ -0,0 +1,33 @@
+// WiFi.h (native) - Verbindungsstatus für Code, der ihn nur abfragt
+//
+// Der Host hat immer "Verbindung"; Sockets, Scans und Access-Point-Betrieb
+// gibt es nicht, Webserver und Wetterabruf bleiben dem ESP32 vorbehalten.
+#ifndef HAL_NATIVE_WIFI_H
+#define HAL_NATIVE_WIFI_H
+
+#include "Arduino.h"
+
+typedef enum {
+    WL_IDLE_STATUS = 0,
+    WL_CONNECTED = 3,
+    WL_DISCONNECTED = 6
+} wl_status_t;
+
+class WiFiClass {
+public:
+    wl_status_t status() { return connected ? WL_CONNECTED : WL_DISCONNECTED; }
+    int8_t RSSI() { return connected ? rssi : 0; }
+
+    void simulate(bool connected, int8_t rssi) {
+        this->connected = connected;
+        this->rssi = rssi;
+    }
+
+private:
+    bool connected = true;
+    int8_t rssi = -55;
+};
+
+extern WiFiClass WiFi;
+
+#endif
@@ -0,0 +1,51 @@
+#include "Wire.h"
+
+#define AHT20_BUS_ADDRESS 0x38
+
+TwoWire Wire;
+
+void TwoWire::beginTransmission(uint8_t address) {
+    this->address = address;
+}
+
+size_t TwoWire::write(uint8_t data) {
+    return 1;
+}
+
+uint8_t TwoWire::endTransmission(bool sendStop) {
+    // 2 = NACK auf die Adresse, wie bei einem fehlenden Gerät
+    if (address != AHT20_BUS_ADDRESS) return 2;
+    triggered = true;
+    return 0;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t count) {
+    if (address != AHT20_BUS_ADDRESS || count > sizeof(response)) return 0;
+
+    // Umrechnung aus dem AHT20-Datenblatt rückwärts: 20 Bit je Wert
+    uint32_t rawHumidity = (uint32_t)(humidity * 1048576.0f / 100.0f);
+    uint32_t rawTemperature = (uint32_t)((temperature + 50.0f) * 1048576.0f / 200.0f);
+    if (rawHumidity > 0xFFFFF) rawHumidity = 0xFFFFF;
+    if (rawTemperature > 0xFFFFF) rawTemperature = 0xFFFFF;
+
+    response[0] = triggered ? 0x18 : 0x98;
+    response[1] = rawHumidity >> 12;
+    response[2] = rawHumidity >> 4;
+    response[3] = ((rawHumidity & 0x0F) << 4) | (rawTemperature >> 16);
+    response[4] = rawTemperature >> 8;
+    response[5] = rawTemperature;
+
+    responseLen = count;
+    responsePos = 0;
+    triggered = false;
+    return count;
+}
+
+int TwoWire::read() {
+    return responsePos < responseLen ? response[responsePos++] : -1;
+}
+
+void TwoWire::setAht20(float temperature, float humidity) {
+    this->temperature = temperature;
+    this->humidity = humidity;
+}
@@ -0,0 +1,37 @@
+// Wire.h (native) - I2C-Bus mit nachgebildetem AHT20 (0x38)
+//
+// Nach dem Messbefehl liefert der "Sensor" die mit setAht20() gesetzten
+// Werte, vorher meldet er "Messung läuft". Andere Adressen antworten nicht.
+#ifndef HAL_NATIVE_WIRE_H
+#define HAL_NATIVE_WIRE_H
+
+#include "Arduino.h"
+
+class TwoWire {
+public:
+    bool begin(int sda = -1, int scl = -1) { return true; }
+
+    void beginTransmission(uint8_t address);
+    size_t write(uint8_t data);
+    uint8_t endTransmission(bool sendStop = true);
+
+    uint8_t requestFrom(uint8_t address, uint8_t count);
+    int read();
+
+    // Werte der nächsten Messung
+    void setAht20(float temperature, float humidity);
+
+private:
+    uint8_t address = 0;
+    bool triggered = false;     // Messbefehl gesendet, Ergebnis liegt bereit
+    float temperature = 21.5f;
+    float humidity = 45.0f;
+
+    uint8_t response[6] = {};
+    uint8_t responseLen = 0;
+    uint8_t responsePos = 0;
+};
+
+extern TwoWire Wire;
+
+#endif
@@ -0,0 +1,288 @@
+#include "alerts.h"
+#include "seqlock.h"
+
+static const char *const typeNames[RULE_TYPES] = {
+    "above",
+    "below",
+    "rate",
+    "stale"
+};
+
+// Regel mit Auswertungszustand; status ist der Teil, den Leser sehen
+struct AlertRule {
+    AlertStatus status;
+    float threshold;
+    float parameter;            // Hysterese (above/below), Fenster in Sekunden (rate)
+    int8_t node;                // -1, solange der Node keine Messung geschickt hat
+    int8_t slot;                // -1, solange der Kanal beim Node fehlt
+    int8_t next;                // nächste Regel desselben Nodes, -1 = Ende
+    uint32_t lastSample;        // stale: Zeitstempel der letzten Messung
+    uint32_t anchorTime[2];     // rate: älterer und neuerer Stützpunkt
+    float anchorValue[2];
+};
+
+static AlertRule rules[ALERT_MAX_RULES];
+static uint8_t ruleCount = 0;
+static int8_t firstRule[NODE_MAX];
+static uint32_t checkedNodes = 0;       // Bit je Node: Regeln schon zugeordnet
+static bool unresolved = false;         // Regeln für Nodes ohne Messung
+static uint32_t lastTick = 0;
+static void (*changeHandler)(const AlertStatus &status) = nullptr;
+
+static_assert(NODE_MAX <= 32, "checkedNodes hat ein Bit je Node");
+
+// Geschrieben wird nur aus dem ingest-Task, gelesen von AsyncTCP (/alerts)
+static SeqLock alertsSeq;
+
+const char *alertRuleTypeName(uint8_t type) {
+    return type < RULE_TYPES ? typeNames[type] : "?";
+}
+
+int alertRuleTypeFromName(const char *name) {
+    for (int i = 0; i < RULE_TYPES; i++) {
+        if (strcmp(name, typeNames[i]) == 0) return i;
+    }
+    return -1;
+}
+
+static void link(uint8_t index, int node) {
+    rules[index].node = node;
+    rules[index].next = firstRule[node];
+    firstRule[node] = index;
+}
+
+// Regeln, deren Node beim Laden noch nicht bekannt war, beim ersten Kontakt zuordnen
+static void resolveNode(uint8_t node) {
+    checkedNodes |= 1UL << node;
+
+    NodeInfo info;
+    if (!nodeGet(node, info)) return;
+
+    unresolved = false;
+    for (uint8_t i = 0; i < ruleCount; i++) {
+        if (rules[i].node >= 0) continue;
+        if (strcmp(rules[i].status.node, info.id) == 0) link(i, node);
+        else unresolved = true;
+    }
+}
+
+// Zerlegt line an ';' in höchstens maxFields Felder, leere Felder bleiben erhalten
+static int splitFields(char *line, char **fields, int maxFields) {
+    int total = 0;
+    char *field = line;
+
+    while (total < maxFields) {
+        fields[total++] = field;
+        char *separator = strchr(field, ';');
+        if (!separator) break;
+        *separator = '\0';
+        field = separator + 1;
+    }
+    return total;
+}
+
+static bool parseRule(char *line, AlertRule &rule) {
+    char *fields[6];
+    int total = splitFields(line, fields, 6);
+    if (total < 5) return false;
+
+    memset(&rule, 0, sizeof(rule));
+    rule.node = -1;
+    rule.slot = -1;
+    rule.next = -1;
+
+    if (strlen(fields[0]) == 0 || strlen(fields[0]) >= ALERT_NAME_LEN || !nodeIdValid(fields[1])) return false;
+    strcpy(rule.status.rule, fields[0]);
+    strcpy(rule.status.node, fields[1]);
+
+    int type = alertRuleTypeFromName(fields[3]);
+    if (type < 0) return false;
+    rule.status.type = type;
+
+    rule.status.kind = -1;
+    if (type != RULE_STALE) {
+        rule.status.kind = channelKindFromName(fields[2]);
+        if (rule.status.kind < 0) return false;
+    }
+
+    char *end;
+    rule.threshold = strtof(fields[4], &end);
+    if (end == fields[4]) return false;
+
+    rule.parameter = total > 5 ? strtof(fields[5], NULL) : 0;
+    if (type == RULE_RATE && rule.parameter <= 0) rule.parameter = ALERT_RATE_WINDOW;
+    if (rule.parameter < 0) rule.parameter = 0;
+
+    return type != RULE_STALE || rule.threshold > 0;
+}
+
+bool alertsBegin(fs::FS &fs, void (*onChange)(const AlertStatus &status)) {
+    changeHandler = onChange;
+    ruleCount = 0;
+    checkedNodes = 0;
+    unresolved = false;
+    for (int i = 0; i < NODE_MAX; i++) firstRule[i] = -1;
+
+    File file = fs.open(ALERTS_FILE, FILE_READ);
+    if (!file) {
+        Serial.println("Keine Alarm-Regeln (" ALERTS_FILE ")");
+        return false;
+    }
+
+    char line[128];
+    int lineNumber = 0;
+
+    while (file.available() && ruleCount < ALERT_MAX_RULES) {
+        size_t len = file.readBytesUntil('\n', line, sizeof(line) - 1);
+        line[len] = '\0';
+        lineNumber++;
+
+        if (len && line[len - 1] == '\r') line[--len] = '\0';
+        if (len == 0 || line[0] == '#') continue;
+
+        AlertRule &rule = rules[ruleCount];
+        if (!parseRule(line, rule)) {
+            Serial.printf("Alarm-Regel in Zeile %d ungültig, wird ignoriert\n", lineNumber);
+            continue;
+        }
+
+        int node = nodeFind(rule.status.node);
+        if (node >= 0) link(ruleCount, node);
+        else unresolved = true;
+        ruleCount++;
+    }
+    file.close();
+
+    Serial.printf("Alarm-Regeln: %u\n", ruleCount);
+    return true;
+}
+
+static void setActive(AlertRule &rule, bool active, float value, uint32_t timestamp) {
+    alertsSeq.writeBegin();
+    rule.status.active = active;
+    rule.status.since = timestamp;
+    rule.status.value = value;
+    alertsSeq.writeEnd();
+
+    Serial.printf("Alarm %s (%s): %s\n", rule.status.rule, rule.status.node, active ? "an" : "aus");
+    if (changeHandler) changeHandler(rule.status);
+}
+
+// Änderung pro Stunde über mindestens ein Fenster. false, solange dafür
+// noch keine zwei Stützpunkte weit genug auseinander liegen.
+static bool sampleRate(AlertRule &rule, float value, uint32_t timestamp, float &rate) {
+    uint32_t window = (uint32_t)rule.parameter;
+
+    // Erste Messung oder lange Lücke: von vorn beginnen
+    if (!rule.anchorTime[1] || timestamp - rule.anchorTime[1] >= 2 * window) {
+        rule.anchorTime[0] = rule.anchorTime[1] = timestamp;
+        rule.anchorValue[0] = rule.anchorValue[1] = value;
+        return false;
+    }
+
+    if (timestamp - rule.anchorTime[1] >= window) {
+        rule.anchorTime[0] = rule.anchorTime[1];
+        rule.anchorValue[0] = rule.anchorValue[1];
+        rule.anchorTime[1] = timestamp;
+        rule.anchorValue[1] = value;
+    }
+
+    uint32_t elapsed = timestamp - rule.anchorTime[0];
+    if (elapsed < window) return false;
+
+    rate = (value - rule.anchorValue[0]) * 3600.0f / elapsed;
+    return true;
+}
+
+void alertsSample(const SensorRecord &record) {
+    if (record.node >= NODE_MAX) return;
+    if (unresolved && !(checkedNodes & (1UL << record.node))) resolveNode(record.node);
+
+    for (int8_t i = firstRule[record.node]; i >= 0; i = rules[i].next) {
+        AlertRule &rule = rules[i];
+
+        if (rule.status.type == RULE_STALE) {
+            if (record.timestamp > rule.lastSample) rule.lastSample = record.timestamp;
+            if (rule.status.active) setActive(rule, false, 0, record.timestamp);
+            continue;
+        }
+
+        // Slots werden nie umsortiert, einmal gefunden gilt er für immer
+        if (rule.slot < 0) {
+            rule.slot = nodeChannelSlot(record.node, (ChannelKind)rule.status.kind, false);
+            if (rule.slot < 0) continue;
+        }
+        if (!(record.valid & (1 << rule.slot))) continue;
+
+        float value = record.values[rule.slot];
+        bool active = rule.status.active;
+
+        switch (rule.status.type) {
+        case RULE_ABOVE:
+            active = value > (active ? rule.threshold - rule.parameter : rule.threshold);
+            break;
+        case RULE_BELOW:
+            active = value < (active ? rule.threshold + rule.parameter : rule.threshold);
+            break;
+        case RULE_RATE: {
+            float rate;
+            if (!sampleRate(rule, value, record.timestamp, rate)) continue;
+            value = rate;
+            active = fabsf(rate) > rule.threshold;
+            break;
+        }
+        }
+
+        if (active != rule.status.active) setActive(rule, active, value, record.timestamp);
+    }
+}
+
+void alertsTick(uint32_t now) {
+    if (now == lastTick || now < SENSOR_LOG_MIN_VALID_TIME) return;
+    lastTick = now;
+
+    for (uint8_t i = 0; i < ruleCount; i++) {
+        AlertRule &rule = rules[i];
+        if (rule.status.type != RULE_STALE || rule.status.active) continue;
+
+        // Noch nie gesehen: Frist läuft ab dem Start
+        if (!rule.lastSample) rule.lastSample = now;
+
+        uint32_t silent = now > rule.lastSample ? now - rule.lastSample : 0;
+        if (silent > rule.threshold) setActive(rule, true, silent, now);
+    }
+}
+
+uint8_t alertsSnapshot(AlertStatus *out) {
+    uint8_t total;
+    uint32_t start;
+    do {
+        start = alertsSeq.readBegin();
+        total = ruleCount;
+        for (uint8_t i = 0; i < total; i++) out[i] = rules[i].status;
+    } while (alertsSeq.readRetry(start));
+    return total;
+}
+
+uint8_t alertsActive() {
+    uint8_t active = 0;
+    uint32_t start;
+    do {
+        start = alertsSeq.readBegin();
+        active = 0;
+        for (uint8_t i = 0; i < ruleCount; i++) active += rules[i].status.active;
+    } while (alertsSeq.readRetry(start));
+    return active;
+}
+
+void alertJsonWrite(JsonWriter &json, const AlertStatus &status) {
+    json.beginObject();
+    json.addString("rule", status.rule);
+    json.addString("node", status.node);
+    if (status.kind >= 0) json.addString("channel", channelKindName(status.kind));
+    json.addString("type", alertRuleTypeName(status.type));
+    json.addBool("active", status.active);
+    json.addUnsigned("since", status.since);
+    json.addFloat("value", status.value);
+    json.endObject();
+}
@@ -0,0 +1,73 @@
+// alerts.h - Regeln und Alarme, ausgewertet bei jeder neuen Messung
+//
+// Die Regeln stehen in /alerts.txt auf der SD-Karte, eine je Zeile
+// ("name;node;kanal;regel;schwelle[;parameter]", # für Kommentare):
+//
+//   keller_kalt;keller;temperature;below;12;0.5    unter 12 an, erst über 12,5 wieder aus
+//   bad_feucht;bad;humidity;above;70;5             über 70 an, erst unter 65 wieder aus
+//   heizung;esp32;temperature;rate;3;1800          mehr als 3 pro Stunde, gemessen über >= 30 min
+//   pico_weg;pico;;stale;900                       15 Minuten keine Messung
+//
+// Ohne Parameter haben above/below keine Hysterese, rate misst über
+// ALERT_RATE_WINDOW. Ausgewertet wird im ingest-Task (pipeline.h): je Messung
+// nur die Regeln ihres Nodes, jede mit fester Arbeit - keine Abfrage des
+// Verlaufs. Für rate hält eine Regel zwei Stützpunkte im Abstand von
+// mindestens einem Fenster. Jeder Wechsel zwischen an und aus geht an den
+// Handler aus alertsBegin() (im Gerät: /events, siehe live_events.h).
+#ifndef ALERTS_H
+#define ALERTS_H
+
+#include <Arduino.h>
+#include "FS.h"
+#include "sensor_log.h"
+#include "node_registry.h"
+#include "json_writer.h"
+
+#define ALERTS_FILE         "/alerts.txt"
+#define ALERT_MAX_RULES     32
+#define ALERT_NAME_LEN      24          // inkl. '\0'
+#define ALERT_RATE_WINDOW   900         // Sekunden, Standard für rate
+
+enum AlertRuleType {
+    RULE_ABOVE = 0,
+    RULE_BELOW,
+    RULE_RATE,
+    RULE_STALE,
+    RULE_TYPES
+};
+
+// Öffentlicher Stand einer Regel, so auch in /alerts und /events
+struct AlertStatus {
+    char rule[ALERT_NAME_LEN];
+    char node[NODE_ID_LEN];
+    int8_t kind;                // ChannelKind, -1 bei stale
+    uint8_t type;               // AlertRuleType
+    bool active;
+    uint32_t since;             // Unix-Zeit des letzten Wechsels, 0 = noch nie
+    float value;                // Wert beim Wechsel: Messwert, Änderung pro Stunde bzw. Sekunden ohne Messung
+};
+
+// Lädt /alerts.txt; onChange bekommt jeden Wechsel einer Regel
+bool alertsBegin(fs::FS &fs, void (*onChange)(const AlertStatus &status));
+
+// Neue Messung auswerten. Nur aus dem ingest-Task und nur in zeitlicher
+// Reihenfolge je Node - Nachlieferungen gehören nicht hierher.
+void alertsSample(const SensorRecord &record);
+
+// Regeln "stale" prüfen; aus dem ingest-Task, höchstens einmal pro Sekunde wirksam
+void alertsTick(uint32_t now);
+
+// Konsistente Kopie aller Regeln nach out (Platz für ALERT_MAX_RULES)
+uint8_t alertsSnapshot(AlertStatus *out);
+
+// Zahl der aktiven Alarme
+uint8_t alertsActive();
+
+// Eine Regel als JSON-Objekt
+void alertJsonWrite(JsonWriter &json, const AlertStatus &status);
+
+// "above" <-> RULE_ABOVE
+const char *alertRuleTypeName(uint8_t type);
+int alertRuleTypeFromName(const char *name);
+
+#endif
@@ -0,0 +1,258 @@
+#include "channel_stats.h"
+#include "record_source.h"
+#include "seqlock.h"
+
+#define CHANNEL_STATS_TMP_FILE  "/stats.tmp"
+
+static const char *const windowNames[STATS_WINDOWS] = { "day", "week", "all" };
+
+struct StatsFileHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint8_t nodes;                          // so viele NodeChannels folgen
+    uint8_t values;                         // SENSOR_LOG_VALUES beim Schreiben
+    uint32_t processed;                     // Log-Indizes davor sind eingerechnet
+    uint32_t revision;                      // sensorLogRevision(), für die processed gilt
+    uint32_t start[STATS_WINDOWS];
+};
+
+static_assert(sizeof(StatsFileHeader) == 28, "StatsFileHeader muss 28 Byte haben");
+
+typedef ChannelStats NodeChannels[STATS_WINDOWS][SENSOR_LOG_VALUES];
+
+static NodeChannels *table = nullptr;       // NODE_MAX Einträge
+static uint32_t windowStart[STATS_WINDOWS];
+static bool dirty = false;
+static fs::FS *statsFs = nullptr;
+
+// Geschrieben wird nur aus dem storage-Task, gelesen von AsyncTCP (/stats)
+static SeqLock statsSeq;
+
+const char *statsWindowName(uint8_t window) {
+    return window < STATS_WINDOWS ? windowNames[window] : "?";
+}
+
+// Beginn des Fensters, in das t fällt (UTC); Wochen beginnen am Montag
+static uint32_t startOf(uint8_t window, uint32_t t) {
+    uint32_t day = t - t % 86400;
+
+    switch (window) {
+    case STATS_DAY:
+        return day;
+    case STATS_WEEK:
+        // Der 1.1.1970 war ein Donnerstag
+        return day - ((t / 86400 + 3) % 7) * 86400;
+    }
+    return 0;
+}
+
+static void accumulate(ChannelStats &stats, float value) {
+    uint32_t n = ++stats.count;
+
+    if (n == 1) {
+        stats.mean = value;
+        stats.m2 = 0;
+        stats.min = value;
+        stats.max = value;
+        return;
+    }
+
+    if (value < stats.min) stats.min = value;
+    if (value > stats.max) stats.max = value;
+
+    double delta = value - stats.mean;
+    stats.mean += delta / n;
+    stats.m2 += delta * (value - stats.mean);
+}
+
+float channelStatsVariance(const ChannelStats &stats) {
+    return stats.count > 1 ? stats.m2 / (stats.count - 1) : 0;
+}
+
+void channelStatsAdd(const SensorRecord &record) {
+    if (!table || record.node >= NODE_MAX || !record.valid) return;
+
+    uint32_t timestamp = record.timestamp;
+    NodeChannels &channels = table[record.node];
+
+    statsSeq.writeBegin();
+
+    // Neuer Tag bzw. neue Woche: das Fenster beginnt für alle Nodes leer
+    for (int window = STATS_DAY; window < STATS_ALL; window++) {
+        uint32_t start = startOf(window, timestamp);
+        if (start <= windowStart[window]) continue;
+
+        for (int node = 0; node < NODE_MAX; node++) memset(table[node][window], 0, sizeof(table[node][window]));
+        windowStart[window] = start;
+    }
+    if (!windowStart[STATS_ALL] || timestamp < windowStart[STATS_ALL]) windowStart[STATS_ALL] = timestamp;
+
+    for (int slot = 0; slot < SENSOR_LOG_VALUES; slot++) {
+        if (!(record.valid & (1 << slot))) continue;
+
+        // Nachlieferungen aus einem früheren Tag bzw. einer früheren Woche zählen nur für "gesamt"
+        for (int window = 0; window < STATS_WINDOWS; window++) {
+            if (window == STATS_ALL || startOf(window, timestamp) == windowStart[window]) {
+                accumulate(channels[window][slot], record.values[slot]);
+            }
+        }
+    }
+
+    statsSeq.writeEnd();
+
+    dirty = true;
+}
+
+void channelStatsFlush() {
+    if (!dirty || !statsFs || !table) return;
+
+    // Nur der storage-Task schreibt, hier also ohne statsSeq
+    StatsFileHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = CHANNEL_STATS_MAGIC;
+    header.version = CHANNEL_STATS_VERSION;
+    header.nodes = nodeCount();
+    header.values = SENSOR_LOG_VALUES;
+    // Jeder Satz im Log ging über channelStatsAdd() (angehängt oder per
+    // sensorLogMerge() eingefügt), der Stand reicht also bis zu dessen Ende
+    header.processed = sensorLogCount();
+    header.revision = sensorLogRevision();
+    memcpy(header.start, windowStart, sizeof(header.start));
+
+    size_t size = header.nodes * sizeof(NodeChannels);
+
+    File file = statsFs->open(CHANNEL_STATS_TMP_FILE, FILE_WRITE);
+    bool ok = file
+           && file.write((const uint8_t *)&header, sizeof(header)) == sizeof(header)
+           && file.write((const uint8_t *)table, size) == size;
+    if (file) file.close();
+
+    // Fehlt die Datei nach einem Abbruch hier, baut channelStatsBegin() neu auf
+    if (ok) {
+        statsFs->remove(CHANNEL_STATS_FILE);
+        ok = statsFs->rename(CHANNEL_STATS_TMP_FILE, CHANNEL_STATS_FILE);
+    }
+
+    if (ok) dirty = false;
+    else Serial.println("Fehler beim Speichern der Statistik!");
+}
+
+// Lädt den Stand und gibt in processed den Log-Index zurück, ab dem
+// nachgeholt wird
+static bool loadStats(fs::FS &fs, uint32_t &processed) {
+    File file = fs.open(CHANNEL_STATS_FILE, FILE_READ);
+    if (!file) return false;
+
+    StatsFileHeader header;
+    bool ok = file.read((uint8_t *)&header, sizeof(header)) == sizeof(header)
+           && header.magic == CHANNEL_STATS_MAGIC
+           && header.version == CHANNEL_STATS_VERSION
+           && header.values == SENSOR_LOG_VALUES
+           && header.nodes <= NODE_MAX
+           && header.revision == sensorLogRevision()
+           && header.processed <= sensorLogCount()
+           && file.size() == sizeof(header) + header.nodes * sizeof(NodeChannels)
+           && file.read((uint8_t *)table, header.nodes * sizeof(NodeChannels)) == header.nodes * sizeof(NodeChannels);
+    file.close();
+
+    if (!ok) {
+        // Abgeleitete Daten: im Zweifel verwerfen und neu aufbauen
+        memset(table, 0, NODE_MAX * sizeof(NodeChannels));
+        return false;
+    }
+
+    memcpy(windowStart, header.start, sizeof(windowStart));
+    processed = header.processed;
+    return true;
+}
+
+bool channelStatsBegin(fs::FS &fs) {
+    statsFs = &fs;
+
+    if (!table) {
+        size_t size = NODE_MAX * sizeof(NodeChannels);
+        table = (NodeChannels *)(psramFound() ? ps_malloc(size) : malloc(size));
+        if (!table) {
+            Serial.println("Kein Speicher für die Statistik!");
+            return false;
+        }
+    }
+
+    memset(table, 0, NODE_MAX * sizeof(NodeChannels));
+    memset(windowStart, 0, sizeof(windowStart));
+    dirty = false;
+
+    // Was nach dem letzten Sichern dazukam; ohne Datei das ganze Log. Nach
+    // dem Index statt dem Zeitstempel, damit Sätze anderer Nodes mit
+    // derselben Sekunde nicht fehlen.
+    uint32_t total = sensorLogCount();
+    uint32_t from;
+    if (!loadStats(fs, from) || from < sensorLogFirstIndex()) from = sensorLogFirstIndex();
+
+    if (from < total) {
+        Serial.printf("Statistik: hole %lu Messungen nach...\n", (unsigned long)(total - from));
+
+        LogRangeSource source(from, total);
+        SensorRecord record;
+        while (source.next(record)) channelStatsAdd(record);
+
+        channelStatsFlush();
+    }
+
+    Serial.printf("Statistik: bis Log-Index %lu\n", (unsigned long)total);
+    return true;
+}
+
+bool channelStatsGet(uint8_t node, uint32_t now, NodeStats &out) {
+    if (!table || node >= NODE_MAX) return false;
+
+    uint32_t start;
+    do {
+        start = statsSeq.readBegin();
+        memcpy(out.start, windowStart, sizeof(out.start));
+        memcpy(out.channels, table[node], sizeof(out.channels));
+    } while (statsSeq.readRetry(start));
+
+    // Seit Mitternacht bzw. Montag noch keine Messung: das Fenster ist leer
+    for (int window = STATS_DAY; window < STATS_ALL; window++) {
+        uint32_t current = startOf(window, now);
+        if (out.start[window] >= current) continue;
+
+        memset(out.channels[window], 0, sizeof(out.channels[window]));
+        out.start[window] = current;
+    }
+    return true;
+}
+
+void channelStatsJsonWrite(JsonWriter &json, uint8_t node, uint32_t now) {
+    NodeInfo info;
+    NodeStats stats;
+    if (!nodeGet(node, info) || !channelStatsGet(node, now, stats)) return;
+
+    json.beginObject();
+    json.addString("node", info.id);
+
+    for (int window = 0; window < STATS_WINDOWS; window++) {
+        json.beginObject(statsWindowName(window));
+        json.addUnsigned("start", stats.start[window]);
+
+        json.beginObject("channels");
+        for (int slot = 0; slot < info.channelCount; slot++) {
+            const ChannelStats &channel = stats.channels[window][slot];
+            if (channel.count == 0) continue;
+
+            json.beginObject(channelKindName(info.channels[slot]));
+            json.addUnsigned("count", channel.count);
+            json.addFloat("min", channel.min);
+            json.addFloat("max", channel.max);
+            json.addFloat("mean", channel.mean);
+            json.addFloat("var", channelStatsVariance(channel), 3);
+            json.endObject();
+        }
+        json.endObject();
+
+        json.endObject();
+    }
+
+    json.endObject();
+}
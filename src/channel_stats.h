@@ -0,0 +1,75 @@
+// channel_stats.h - Laufende Statistik je Node und Kanal (Welford)
+//
+// Jede geloggte Messung (storage-Task, auch Nachlieferungen) wird in drei
+// Fenster eingerechnet: aktueller Tag, aktuelle Woche (ab Montag) und
+// "gesamt" - Grenzen wie bei den Rollups in UTC. Je Fenster, Node und Kanal
+// stehen Anzahl, min, max, Mittel und die Summe der quadrierten Abweichungen
+// (Welford); Varianz und Mittel kosten beim Abfragen also nichts, und der
+// Speicher bleibt gleich, egal wie lang das Log wird.
+//
+// Gesichert wird mit channelStatsFlush() zusammen mit dem Log nach
+// /stats.bin, mit dem Log-Index, bis zu dem alles eingerechnet ist, und
+// sensorLogRevision(). Was ab dort dazukam, holt channelStatsBegin() aus dem
+// Log nach; hat sich die Revision seitdem geändert (Nachlieferungen, die
+// nicht mehr mitgesichert wurden) oder fehlt die Datei, einmal das ganze Log.
+#ifndef CHANNEL_STATS_H
+#define CHANNEL_STATS_H
+
+#include <Arduino.h>
+#include "FS.h"
+#include "sensor_log.h"
+#include "node_registry.h"
+#include "json_writer.h"
+
+#define CHANNEL_STATS_FILE      "/stats.bin"
+#define CHANNEL_STATS_MAGIC     0x54535348UL   // "HSST"
+#define CHANNEL_STATS_VERSION   2
+
+enum StatsWindow {
+    STATS_DAY = 0,
+    STATS_WEEK,
+    STATS_ALL,
+    STATS_WINDOWS
+};
+
+struct ChannelStats {
+    double mean;
+    double m2;                  // Summe der quadrierten Abweichungen vom Mittel
+    uint32_t count;
+    float min;
+    float max;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(ChannelStats) == 32, "ChannelStats muss 32 Byte haben");
+
+// Stand eines Nodes
+struct NodeStats {
+    uint32_t start[STATS_WINDOWS];          // Fensterbeginn; bei STATS_ALL die älteste Messung
+    ChannelStats channels[STATS_WINDOWS][SENSOR_LOG_VALUES];
+};
+
+// Lädt /stats.bin und holt fehlende Messungen aus dem Log nach.
+// Muss nach sensorLogBegin() laufen.
+bool channelStatsBegin(fs::FS &fs);
+
+// Messung einrechnen; nur aus dem storage-Task
+void channelStatsAdd(const SensorRecord &record);
+
+// Geänderten Stand nach /stats.bin schreiben
+void channelStatsFlush();
+
+// Konsistente Kopie für einen Node. Fenster, die vor now geendet haben,
+// kommen leer zurück. false bei ungültigem Node.
+bool channelStatsGet(uint8_t node, uint32_t now, NodeStats &out);
+
+// {"node":"esp32","day":{"start":...,"channels":{"temperature":{"count":..,"min":..,
+//  "max":..,"mean":..,"var":..},...}},"week":{...},"all":{...}}
+void channelStatsJsonWrite(JsonWriter &json, uint8_t node, uint32_t now);
+
+// Varianz (Stichprobe), 0 bei weniger als zwei Werten
+float channelStatsVariance(const ChannelStats &stats);
+
+const char *statsWindowName(uint8_t window);
+
+#endif
@@ -0,0 +1,191 @@
+#include "downsample.h"
+#include <new>
+
+static const char *const aggNames[] = { "min", "max", "avg", "lttb" };
+
+bool historyAggFromName(const char *name, HistoryAgg &agg) {
+    for (int i = 0; i < (int)(sizeof(aggNames) / sizeof(aggNames[0])); i++) {
+        if (strcmp(name, aggNames[i]) == 0) {
+            agg = (HistoryAgg)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+DownsampleSource::DownsampleSource(std::unique_ptr<RecordSource> input, uint32_t from, uint32_t to,
+                                   uint16_t points, HistoryAgg agg, int channel)
+    : input(std::move(input)), from(from), points(points), agg(agg), channel(channel),
+      haveHeld(false), started(false), buckets(nullptr), emittedAny(false),
+      prevTs(0.0f), prevValue(0.0f) {
+    if (this->points == 0) this->points = 1;
+    if (this->points > HISTORY_MAX_POINTS) this->points = HISTORY_MAX_POINTS;
+    if (this->channel < 0 || this->channel >= SENSOR_LOG_VALUES) this->channel = 0;
+
+    uint32_t span = to > from ? to - from : 0;
+    width = span / this->points + 1;
+}
+
+DownsampleSource::~DownsampleSource() {
+    delete[] buckets;
+}
+
+uint16_t DownsampleSource::bucketOf(uint32_t timestamp) const {
+    if (timestamp <= from) return 0;
+
+    uint32_t bucket = (timestamp - from) / width;
+    return bucket >= points ? points - 1 : bucket;
+}
+
+float DownsampleSource::relativeTs(uint32_t timestamp) const {
+    return timestamp > from ? (float)(timestamp - from) : 0.0f;
+}
+
+bool DownsampleSource::advance() {
+    haveHeld = input->next(held);
+    return haveHeld;
+}
+
+bool DownsampleSource::next(SensorRecord &record) {
+    if (!started) {
+        started = true;
+        // Ohne Speicher für die Fenstermittel wenigstens gemittelt ausliefern
+        if (agg == AGG_LTTB && !prepareLttb()) agg = AGG_AVG;
+        advance();
+    }
+
+    return agg == AGG_LTTB ? nextLttb(record) : nextAggregate(record);
+}
+
+void DownsampleSource::rewind() {
+    input->rewind();
+    haveHeld = false;
+    started = false;
+}
+
+bool DownsampleSource::nextAggregate(SensorRecord &record) {
+    if (!haveHeld) return false;
+
+    uint16_t bucket = bucketOf(held.timestamp);
+    uint32_t count = 0;
+    uint64_t sumTs = 0;
+    uint32_t counts[SENSOR_LOG_VALUES] = { 0 };
+    double sums[SENSOR_LOG_VALUES] = { 0 };
+
+    memset(&record, 0, sizeof(record));
+    record.node = held.node;
+
+    do {
+        count++;
+        sumTs += held.timestamp;
+
+        // Nur gemessene Slots zählen
+        for (int slot = 0; slot < SENSOR_LOG_VALUES; slot++) {
+            if (!(held.valid & (1 << slot))) continue;
+
+            float value = held.values[slot];
+            sums[slot] += value;
+
+            if (counts[slot]++ == 0) record.values[slot] = value;
+            else if (agg == AGG_MIN && value < record.values[slot]) record.values[slot] = value;
+            else if (agg == AGG_MAX && value > record.values[slot]) record.values[slot] = value;
+        }
+    } while (advance() && bucketOf(held.timestamp) == bucket);
+
+    record.timestamp = (uint32_t)(sumTs / count);
+
+    for (int slot = 0; slot < SENSOR_LOG_VALUES; slot++) {
+        if (counts[slot] == 0) continue;
+
+        record.valid |= 1 << slot;
+        if (agg == AGG_AVG) record.values[slot] = (float)(sums[slot] / counts[slot]);
+    }
+
+    return true;
+}
+
+// Erster Durchgang: Mittelwert (Zeit und Kanal) jedes Fensters
+bool DownsampleSource::prepareLttb() {
+    if (!buckets) {
+        buckets = new (std::nothrow) LttbBucket[points];
+        if (!buckets) return false;
+    }
+    memset(buckets, 0, points * sizeof(LttbBucket));
+
+    SensorRecord record;
+    while (input->next(record)) {
+        if (!(record.valid & (1 << channel))) continue;
+
+        LttbBucket &bucket = buckets[bucketOf(record.timestamp)];
+        bucket.count++;
+        bucket.ts += (relativeTs(record.timestamp) - bucket.ts) / bucket.count;
+        bucket.value += (record.values[channel] - bucket.value) / bucket.count;
+    }
+    input->rewind();
+
+    emittedAny = false;
+    return true;
+}
+
+bool DownsampleSource::nextLttb(SensorRecord &record) {
+    // Der erste Datensatz wird immer übernommen und steht für sein ganzes
+    // Fenster; gewählt wird erst ab dem nächsten, sonst wären es points + 1
+    if (!emittedAny) {
+        if (!haveHeld) return false;
+
+        record = held;
+        emittedAny = true;
+        prevTs = relativeTs(record.timestamp);
+        prevValue = record.values[channel];
+
+        uint16_t firstBucket = bucketOf(record.timestamp);
+        while (advance() && bucketOf(held.timestamp) == firstBucket) {
+        }
+        return true;
+    }
+
+    // Fenster ohne Messwert im Kanal werden übersprungen
+    while (haveHeld) {
+        uint16_t bucket = bucketOf(held.timestamp);
+
+        // Punkt C: Mittel des nächsten belegten Fensters
+        int nextBucket = -1;
+        for (int i = bucket + 1; i < points; i++) {
+            if (buckets[i].count > 0) {
+                nextBucket = i;
+                break;
+            }
+        }
+
+        float bestArea = -1.0f;
+
+        do {
+            if (!(held.valid & (1 << channel))) continue;
+
+            if (nextBucket < 0) {
+                // Letztes Fenster: der letzte Datensatz gewinnt
+                record = held;
+                bestArea = 0.0f;
+                continue;
+            }
+
+            const LttbBucket &c = buckets[nextBucket];
+            float ts = relativeTs(held.timestamp);
+            float value = held.values[channel];
+            float area = fabsf((prevTs - c.ts) * (value - prevValue) - (prevTs - ts) * (c.value - prevValue));
+
+            if (area > bestArea) {
+                bestArea = area;
+                record = held;
+            }
+        } while (advance() && bucketOf(held.timestamp) == bucket);
+
+        if (bestArea >= 0.0f) {
+            prevTs = relativeTs(record.timestamp);
+            prevValue = record.values[channel];
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,69 @@
+// downsample.h - Reduziert eine Datensatzquelle auf eine feste Punktzahl
+//
+// Der Zeitbereich [from, to] wird in points gleich breite Fenster geteilt.
+// min/max/avg fassen jedes Fenster zu einem Datensatz zusammen (Zeitstempel =
+// Mittel der Zeitstempel im Fenster) und laufen in einem Durchgang mit
+// konstantem Speicher. lttb (Largest-Triangle-Three-Buckets) wählt pro Fenster
+// den echten Datensatz, der den Verlauf von Slot `channel` am besten erhält; dafür
+// werden im ersten Durchgang die Fenstermittel bestimmt (12 Byte pro Fenster).
+#ifndef DOWNSAMPLE_H
+#define DOWNSAMPLE_H
+
+#include <Arduino.h>
+#include "record_source.h"
+#include <memory>
+
+#define HISTORY_MAX_POINTS 1000
+
+enum HistoryAgg {
+    AGG_MIN = 0,
+    AGG_MAX,
+    AGG_AVG,
+    AGG_LTTB
+};
+
+// "min", "max", "avg", "lttb" -> HistoryAgg
+bool historyAggFromName(const char *name, HistoryAgg &agg);
+
+class DownsampleSource : public RecordSource {
+public:
+    DownsampleSource(std::unique_ptr<RecordSource> input, uint32_t from, uint32_t to,
+                     uint16_t points, HistoryAgg agg, int channel);
+    ~DownsampleSource();
+
+    bool next(SensorRecord &record) override;
+    void rewind() override;
+
+private:
+    struct LttbBucket {
+        float ts;           // Sekunden ab from
+        float value;
+        uint32_t count;
+    };
+
+    uint16_t bucketOf(uint32_t timestamp) const;
+    bool nextAggregate(SensorRecord &record);
+    bool nextLttb(SensorRecord &record);
+    bool prepareLttb();
+    bool advance();
+    float relativeTs(uint32_t timestamp) const;
+
+    std::unique_ptr<RecordSource> input;
+    uint32_t from;
+    uint32_t width;
+    uint16_t points;
+    HistoryAgg agg;
+    int channel;
+
+    SensorRecord held;
+    bool haveHeld;
+    bool started;
+
+    // nur für lttb
+    LttbBucket *buckets;
+    bool emittedAny;
+    float prevTs;
+    float prevValue;
+};
+
+#endif
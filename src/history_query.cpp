@@ -0,0 +1,122 @@
+#include "history_query.h"
+#include "rollup.h"
+#include "sample_ring.h"
+
+void historyQueryInit(HistoryQuery &query) {
+    query.node = NODE_LOCAL;
+    query.from = 0;
+    query.to = 0;
+    query.tail = HISTORY_DEFAULT_TAIL;
+    query.since = HISTORY_NO_CURSOR;
+    query.points = 0;
+    query.agg = AGG_AVG;
+    query.channel = 0;
+}
+
+// Zeitsuche und Einzelzugriffe zuerst im Messwert-Puffer, nur ältere Daten von der SD
+static uint32_t lowerBound(uint32_t t) {
+    uint32_t index;
+    if (sampleRingLowerBound(t, index)) return index;
+    return sensorLogLowerBound(t);
+}
+
+static bool readRecord(uint32_t index, SensorRecord &record) {
+    return sampleRingReadRange(index, &record, 1) == 1 || sensorLogRead(index, record);
+}
+
+static size_t readRange(uint32_t first, SensorRecord *records, size_t maxRecords) {
+    size_t count = sampleRingReadRange(first, records, maxRecords);
+    return count ? count : sensorLogReadRange(first, records, maxRecords);
+}
+
+// Index, ab dem die letzten tail Datensätze des Nodes liegen. Die Datensätze
+// aller Nodes liegen gemischt im Log, daher wird blockweise rückwärts gezählt.
+static uint32_t tailStart(uint8_t node, uint32_t tail, uint32_t total) {
+    SensorRecord block[RECORD_SOURCE_BLOCK_RECORDS];
+    uint32_t limit = tail > UINT32_MAX / HISTORY_TAIL_SCAN_FACTOR ? UINT32_MAX : tail * HISTORY_TAIL_SCAN_FACTOR;
+    uint32_t oldest = sensorLogFirstIndex();
+    uint32_t end = total;
+    uint32_t found = 0;
+
+    while (end > oldest && total - end < limit) {
+        uint32_t first = end > oldest + RECORD_SOURCE_BLOCK_RECORDS ? end - RECORD_SOURCE_BLOCK_RECORDS : oldest;
+        size_t count = readRange(first, block, end - first);
+        if (count != end - first) break;
+
+        for (size_t i = count; i-- > 0;) {
+            if (block[i].node == node && ++found == tail) return first + i;
+        }
+        end = first;
+    }
+
+    return end;
+}
+
+std::unique_ptr<RecordSource> historyOpen(const HistoryQuery &query, uint32_t *next) {
+    uint32_t total = sensorLogCount();
+    uint32_t first;
+    uint32_t end;
+
+    if (query.since != HISTORY_NO_CURSOR) {
+        // Cursor aus einer früheren Antwort; vor dem Logbeginn liegt nichts mehr
+        uint32_t oldest = sensorLogFirstIndex();
+        first = query.since > oldest ? query.since : oldest;
+        end = total;
+        if (first > end) first = end;
+    } else if (query.from || query.to) {
+        first = query.from ? lowerBound(query.from) : sensorLogFirstIndex();
+        end = query.to ? lowerBound(query.to + 1) : total;
+        if (end < first) end = first;
+    } else {
+        end = total;
+        first = tailStart(query.node, query.tail, total);
+    }
+
+    if (next) *next = end;
+
+    if (query.points == 0 || end - first <= query.points) {
+        return std::unique_ptr<RecordSource>(new LogRangeSource(first, end, query.node));
+    }
+
+    // Fenstergrenzen aus dem tatsächlich vorhandenen Zeitbereich
+    SensorRecord firstRecord;
+    SensorRecord lastRecord;
+    if (!readRecord(first, firstRecord) || !readRecord(end - 1, lastRecord)) {
+        return std::unique_ptr<RecordSource>(new LogRangeSource(first, end, query.node));
+    }
+
+    uint32_t from = firstRecord.timestamp;
+    uint32_t to = lastRecord.timestamp;
+    uint32_t window = (to - from) / query.points;
+
+    // Gröbste Rollup-Stufe, deren Fenster noch in ein Ausgabefenster passt
+    std::unique_ptr<RecordSource> source;
+    uint32_t available = end - first;
+
+    for (int tier = ROLLUP_TIERS - 1; tier >= 0; tier--) {
+        RollupTier rollupTier = (RollupTier)tier;
+        uint32_t width = rollupWidth(rollupTier);
+        if (!rollupReady(rollupTier) || width > window) continue;
+
+        // Auch das Fenster mitnehmen, das vor from beginnt und es enthält
+        uint32_t tierFirst = rollupLowerBound(rollupTier, query.node, from > width ? from - width + 1 : 0);
+        uint32_t tierEnd = rollupLowerBound(rollupTier, query.node, to + 1);
+        if (tierEnd <= tierFirst) continue;
+
+        source.reset(new RollupSource(rollupTier, tierFirst, tierEnd, query.node, query.agg));
+        available = tierEnd - tierFirst;
+        break;
+    }
+
+    if (!source) source.reset(new LogRangeSource(first, end, query.node));
+    if (available <= query.points) return source;
+
+    return std::unique_ptr<RecordSource>(new DownsampleSource(
+        std::move(source),
+        from,
+        to,
+        query.points,
+        query.agg,
+        query.channel
+    ));
+}
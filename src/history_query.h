@@ -0,0 +1,44 @@
+// history_query.h - Plant eine /sd-data-Abfrage und liefert die passende Quelle
+#ifndef HISTORY_QUERY_H
+#define HISTORY_QUERY_H
+
+#include <Arduino.h>
+#include "record_source.h"
+#include "downsample.h"
+#include "node_registry.h"
+#include <memory>
+
+#define HISTORY_DEFAULT_TAIL 100
+#define HISTORY_MAX_TAIL 1000           // größtes ?n=, die Suche läuft im AsyncTCP-Task
+#define HISTORY_DEFAULT_POINTS 500
+#define HISTORY_NO_CURSOR 0xFFFFFFFFUL
+
+// Für ?n= wird höchstens so weit rückwärts gesucht (Datensätze pro gesuchtem
+// Datensatz), damit ein Node ohne Daten nicht das ganze Log lesen lässt
+#define HISTORY_TAIL_SCAN_FACTOR (NODE_MAX * 2)
+
+struct HistoryQuery {
+    uint8_t node;           // Index in der Node-Registry
+    uint32_t from;          // Unix-Zeit, 0 = ab Logbeginn
+    uint32_t to;            // Unix-Zeit inklusive, 0 = bis Logende
+    uint32_t tail;          // ohne from/to: nur die letzten tail Datensätze des Nodes
+    uint32_t since;         // Cursor: erst ab diesem Log-Index (siehe next), statt tail
+    uint16_t points;        // 0 = Rohdaten, sonst höchstens so viele Punkte
+    HistoryAgg agg;
+    int channel;            // für lttb: Slot des Kanals, dessen Verlauf erhalten bleibt
+};
+
+void historyQueryInit(HistoryQuery &query);
+
+// Liefert die Quelle für die Abfrage. Hat der Bereich nicht mehr als
+// query.points Datensätze, werden Rohdaten ausgeliefert. Sonst wird aus der
+// gröbsten Rollup-Stufe gelesen, deren Fensterbreite <= (to - from) / points
+// ist, und bei Bedarf noch auf points Punkte reduziert.
+//
+// next bekommt den Log-Index hinter dem Bereich: als since der nächsten
+// Abfrage liefert er genau die Datensätze, die seitdem dazugekommen sind -
+// solange sensorLogRevision() gleich bleibt; nach dem Einsortieren von
+// Nachlieferungen muss der Client neu laden.
+std::unique_ptr<RecordSource> historyOpen(const HistoryQuery &query, uint32_t *next = nullptr);
+
+#endif
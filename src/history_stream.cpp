@@ -0,0 +1,104 @@
+#include "history_stream.h"
+#include <math.h>
+
+HistoryStream::HistoryStream(std::unique_ptr<RecordSource> source, uint8_t node, uint32_t next)
+    : source(std::move(source)), state(STATE_HEADER), lines(0), next(next), revision(sensorLogRevision()),
+      pendingLen(0), pendingPos(0) {
+    if (!nodeGet(node, this->node)) memset(&this->node, 0, sizeof(this->node));
+}
+
+size_t HistoryStream::read(uint8_t *buffer, size_t maxLen) {
+    size_t written = 0;
+
+    while (written < maxLen) {
+        if (pendingPos == pendingLen && !nextPiece()) break;
+
+        size_t len = pendingLen - pendingPos;
+        if (len > maxLen - written) len = maxLen - written;
+
+        memcpy(buffer + written, pending + pendingPos, len);
+        pendingPos += len;
+        written += len;
+    }
+
+    return written;
+}
+
+int HistoryStream::formatHeader() {
+    int len = snprintf(pending, sizeof(pending), "{\"status\":\"ok\",\"node\":\"%s\",\"channels\":[", node.id);
+
+    for (int i = 0; i < node.channelCount && len < (int)sizeof(pending); i++) {
+        len += snprintf(pending + len, sizeof(pending) - len, "%s\"%s\"",
+                        i > 0 ? "," : "", channelKindName(node.channels[i]));
+    }
+
+    if (len < (int)sizeof(pending)) {
+        len += snprintf(pending + len, sizeof(pending) - len, "],\"data\":\"");
+    }
+    return len;
+}
+
+// Längste Zeile: Zeitstempel (10) + je Kanal ";-999999.99" (11) + "\\n" (2).
+// Werte ab SENSOR_VALUE_MAX (Logs von vor der Prüfung in ingestSample())
+// bleiben leer; passt eine Zeile trotzdem nicht, wird sie ausgelassen (-1)
+// statt ohne Zeilenende gesendet.
+int HistoryStream::formatRecord(const SensorRecord &record) {
+    static_assert(sizeof(pending) > 10 + SENSOR_LOG_VALUES * 11 + 2, "pending zu klein für eine Zeile");
+
+    int len = snprintf(pending, sizeof(pending), "%lu", (unsigned long)record.timestamp);
+
+    for (int i = 0; i < node.channelCount && len < (int)sizeof(pending); i++) {
+        float value = record.values[i];
+        if ((record.valid & (1 << i)) && isfinite(value) && fabsf(value) < SENSOR_VALUE_MAX) {
+            len += snprintf(pending + len, sizeof(pending) - len, ";%.2f", value);
+        } else {
+            len += snprintf(pending + len, sizeof(pending) - len, ";");
+        }
+    }
+
+    // Zeilenumbruch als JSON-Escape, der Client sieht "\n"
+    if (len < (int)sizeof(pending)) {
+        len += snprintf(pending + len, sizeof(pending) - len, "\\n");
+    }
+    return len < (int)sizeof(pending) ? len : -1;
+}
+
+// Legt das nächste Stück der Antwort in pending ab
+bool HistoryStream::nextPiece() {
+    int len = 0;
+    SensorRecord record;
+
+    switch (state) {
+        case STATE_HEADER:
+            len = formatHeader();
+            state = STATE_RECORDS;
+            break;
+
+        case STATE_RECORDS:
+            while (source->next(record)) {
+                len = formatRecord(record);
+                if (len < 0) continue;
+                lines++;
+                break;
+            }
+            if (len > 0) break;
+            state = STATE_FOOTER;
+            // fall through
+
+        case STATE_FOOTER:
+            len = snprintf(pending, sizeof(pending), "\",\"lines\":%lu,\"next\":%lu,\"rev\":%lu}",
+                           (unsigned long)lines, (unsigned long)next, (unsigned long)revision);
+            state = STATE_DONE;
+            break;
+
+        case STATE_DONE:
+            return false;
+    }
+
+    if (len < 0) len = 0;
+    if ((size_t)len >= sizeof(pending)) len = sizeof(pending) - 1;
+
+    pendingLen = len;
+    pendingPos = 0;
+    return true;
+}
@@ -0,0 +1,49 @@
+// history_stream.h - Erzeugt die /sd-data-Antwort stückweise aus einer RecordSource
+//
+// Statt die komplette Antwort in einen Puffer zu schreiben, füllt read()
+// jeweils den Sendepuffer des Webservers. Der Speicherbedarf pro Anfrage ist
+// damit konstant (ein Block Datensätze + eine Zeile), egal wie viele
+// Datensätze ausgeliefert werden.
+//
+// Format:
+//   {"status":"ok","node":"<id>","channels":["temperature",...],
+//    "data":"<ts>;<wert>;...\n...","lines":<n>,"next":<cursor>,"rev":<revision>}
+// Eine Zeile hat einen Wert je Kanal des Nodes; nicht gemessene Werte bleiben
+// leer. next ist der Cursor für ?since= (siehe historyOpen()); er gilt nur,
+// solange rev (sensorLogRevision()) gleich bleibt.
+#ifndef HISTORY_STREAM_H
+#define HISTORY_STREAM_H
+
+#include <Arduino.h>
+#include "record_source.h"
+#include "node_registry.h"
+#include <memory>
+
+class HistoryStream {
+public:
+    // Gibt alles aus, was source für node liefert; der Stream übernimmt die Quelle
+    HistoryStream(std::unique_ptr<RecordSource> source, uint8_t node, uint32_t next = 0);
+
+    // Füllt buffer mit bis zu maxLen Bytes, 0 = Antwort vollständig
+    size_t read(uint8_t *buffer, size_t maxLen);
+
+private:
+    enum State { STATE_HEADER, STATE_RECORDS, STATE_FOOTER, STATE_DONE };
+
+    bool nextPiece();
+    int formatHeader();
+    int formatRecord(const SensorRecord &record);
+
+    std::unique_ptr<RecordSource> source;
+    NodeInfo node;
+    State state;
+    uint32_t lines;
+    uint32_t next;
+    uint32_t revision;
+
+    char pending[192];
+    size_t pendingLen;
+    size_t pendingPos;
+};
+
+#endif
@@ -0,0 +1,251 @@
+#include "ingest.h"
+#include <math.h>
+#include <time.h>
+
+static QueueHandle_t pendingQueue = NULL;
+
+// Prüfen und Einreihen laufen unter einer Sperre, damit die Warteschlange
+// auch bei gleichzeitigen Aufrufen aus dem acquisition-Task, AsyncTCP und UDP
+// sortiert bleibt
+static SemaphoreHandle_t queueLock = NULL;
+
+// Neueste angenommene Messung je Node seit dem Start; verspätet ist eine
+// Messung nur gegenüber ihrem eigenen Node, nicht gegenüber den anderen
+static uint32_t newestTimestamp[NODE_MAX];
+
+// Für /system: höchster Füllstand und abgewiesene Messungen (Queue voll)
+static uint32_t queueHighWater = 0;
+static uint32_t queueDropped = 0;
+
+bool ingestBegin() {
+    if (!pendingQueue) pendingQueue = xQueueCreate(INGEST_QUEUE_LENGTH, sizeof(SensorRecord));
+    if (!queueLock) queueLock = xSemaphoreCreateMutex();
+    memset(newestTimestamp, 0, sizeof(newestTimestamp));
+    return pendingQueue != NULL && queueLock != NULL;
+}
+
+// sent = Zeitstempel, den der Node mitgeschickt hat, 0 = keiner
+static IngestStatus enqueue(const SensorRecord &record, uint32_t seq, uint32_t sent) {
+    if (!pendingQueue || !queueLock) return INGEST_QUEUE_FULL;
+
+    IngestStatus status = INGEST_OK;
+    xSemaphoreTake(queueLock, portMAX_DELAY);
+
+    // Ohne gültige Uhr wird ohnehin nicht geloggt, nur die Anzeige aktualisiert
+    bool ordered = record.timestamp >= SENSOR_LOG_MIN_VALID_TIME && record.node < NODE_MAX;
+    bool sequenced = seq != INGEST_NO_SEQUENCE;
+
+    // Die laufende Nummer gilt erst als angenommen, wenn die Messung in der
+    // Warteschlange steht; sonst ginge sie beim erneuten Senden verloren
+    if (sequenced && !nodeSequenceIsNew(record.node, seq, sent)) {
+        status = INGEST_DUPLICATE;
+    } else if (ordered && record.timestamp + INGEST_BACKFILL_MAX_AGE < newestTimestamp[record.node]) {
+        status = INGEST_LATE;
+    } else if (xQueueSend(pendingQueue, &record, 0) != pdTRUE) {
+        status = INGEST_QUEUE_FULL;
+        queueDropped++;
+    } else {
+        if (ordered && record.timestamp > newestTimestamp[record.node]) newestTimestamp[record.node] = record.timestamp;
+        if (sequenced) nodeSequenceCommit(record.node, seq, sent);
+
+        uint32_t depth = uxQueueMessagesWaiting(pendingQueue);
+        if (depth > queueHighWater) queueHighWater = depth;
+    }
+
+    xSemaphoreGive(queueLock);
+    return status;
+}
+
+IngestStatus ingestSample(uint8_t node, uint32_t timestamp, const uint8_t *kinds, const float *values, size_t count,
+                          uint32_t seq) {
+    SensorRecord record;
+    memset(&record, 0, sizeof(record));
+
+    uint32_t now = (uint32_t)time(nullptr);
+    if (timestamp && now >= SENSOR_LOG_MIN_VALID_TIME && timestamp > now + INGEST_MAX_CLOCK_SKEW) {
+        return INGEST_FUTURE;
+    }
+
+    record.timestamp = timestamp ? timestamp : now;
+    record.node = node;
+
+    bool invalid = false;
+    for (size_t i = 0; i < count; i++) {
+        if (!isfinite(values[i]) || fabsf(values[i]) >= SENSOR_VALUE_MAX) {
+            invalid = true;
+            continue;
+        }
+
+        int slot = nodeChannelSlot(node, (ChannelKind)kinds[i], true);
+        if (slot < 0) continue;
+
+        record.values[slot] = values[i];
+        record.valid |= 1 << slot;
+    }
+
+    if (!record.valid) return invalid ? INGEST_INVALID : INGEST_EMPTY;
+
+    IngestStatus status = enqueue(record, seq, timestamp);
+    if (status == INGEST_QUEUE_FULL) Serial.println("Ingest-Warteschlange voll, Messung wird nicht geloggt!");
+    if (status == INGEST_OK) nodeUpdate(record);
+
+    return status;
+}
+
+IngestStatus ingestJson(uint8_t node, JsonObjectConst sample) {
+    uint8_t kinds[CHANNEL_KINDS];
+    float values[CHANNEL_KINDS];
+    size_t count = 0;
+
+    for (int kind = 0; kind < CHANNEL_KINDS; kind++) {
+        JsonVariantConst value = sample[channelKindName(kind)];
+        if (!value.is<float>()) continue;
+
+        kinds[count] = kind;
+        values[count] = value.as<float>();
+        count++;
+    }
+
+    if (count == 0) return INGEST_EMPTY;
+
+    uint32_t timestamp = sample["timestamp"] | 0UL;
+    JsonVariantConst seq = sample["seq"];
+    return ingestSample(node, timestamp, kinds, values, count,
+                        seq.is<uint32_t>() ? seq.as<uint32_t>() : INGEST_NO_SEQUENCE);
+}
+
+// Reader für ArduinoJson: deserializeJson() liest nur bis zum Ende des
+// nächsten Werts, der Rest bleibt für den nächsten Aufruf stehen
+struct BodyReader {
+    const char *pos;
+    const char *end;
+
+    int read() {
+        return pos < end ? (unsigned char)*pos++ : -1;
+    }
+
+    size_t readBytes(char *buffer, size_t length) {
+        size_t n = end - pos;
+        if (n > length) n = length;
+        memcpy(buffer, pos, n);
+        pos += n;
+        return n;
+    }
+};
+
+static void reject(IngestAck &ack, int index, IngestStatus status) {
+    ack.rejected++;
+    if (ack.firstRejected < 0) {
+        ack.firstRejected = index;
+        ack.firstError = status;
+    }
+}
+
+void ingestBatch(uint8_t node, const char *body, size_t len, IngestAck &ack) {
+    ack.accepted = 0;
+    ack.duplicates = 0;
+    ack.rejected = 0;
+    ack.firstRejected = -1;
+    ack.firstError = INGEST_OK;
+    ack.retryFrom = -1;
+
+    BodyReader reader = { body, body + len };
+    JsonDocument doc;
+
+    while (reader.pos < reader.end && isspace((unsigned char)*reader.pos)) reader.pos++;
+    bool array = reader.pos < reader.end && *reader.pos == '[';
+    if (array) reader.pos++;
+
+    for (int index = 0;; index++) {
+        // Trennzeichen zwischen den Messungen: Komma (Array) oder Zeilenumbruch (NDJSON)
+        while (reader.pos < reader.end && (isspace((unsigned char)*reader.pos) || *reader.pos == ',')) reader.pos++;
+
+        if (reader.pos == reader.end) {
+            if (array) reject(ack, index, INGEST_PARSE_ERROR);
+            break;
+        }
+        if (array && *reader.pos == ']') break;
+
+        if (deserializeJson(doc, reader)) {
+            reject(ack, index, INGEST_PARSE_ERROR);
+            break;
+        }
+
+        IngestStatus status = doc.is<JsonObject>() ? ingestJson(node, doc.as<JsonObjectConst>()) : INGEST_EMPTY;
+
+        if (status == INGEST_OK) {
+            ack.accepted++;
+        } else if (status == INGEST_DUPLICATE) {
+            ack.duplicates++;
+        } else if (status == INGEST_QUEUE_FULL) {
+            // Alles Weitere würde ebenfalls abgelehnt; der Node sendet ab hier neu
+            reject(ack, index, status);
+            ack.retryFrom = index;
+            break;
+        } else {
+            reject(ack, index, status);
+        }
+    }
+
+    ack.nextSequence = nodeSequenceNext(node);
+}
+
+const char *ingestStatusName(IngestStatus status) {
+    switch (status) {
+        case INGEST_OK:          return "ok";
+        case INGEST_EMPTY:       return "empty";
+        case INGEST_LATE:        return "late";
+        case INGEST_FUTURE:      return "future";
+        case INGEST_QUEUE_FULL:  return "busy";
+        case INGEST_PARSE_ERROR: return "parse_error";
+        case INGEST_DUPLICATE:   return "duplicate";
+        case INGEST_INVALID:     return "invalid";
+    }
+    return "unknown";
+}
+
+IngestBody *ingestBodyCreate(size_t total) {
+    bool overflow = total > INGEST_BODY_MAX;
+    size_t capacity = overflow ? 0 : (total ? total : INGEST_BODY_MAX);
+
+    IngestBody *body = (IngestBody *)malloc(sizeof(IngestBody) + capacity);
+    if (!body) return NULL;
+
+    body->capacity = capacity;
+    body->length = 0;
+    body->overflow = overflow;
+    return body;
+}
+
+void ingestBodyAppend(IngestBody *body, const uint8_t *data, size_t len, size_t index) {
+    if (!body || body->overflow) return;
+
+    if (index + len > body->capacity) {
+        body->overflow = true;
+        return;
+    }
+
+    memcpy(body->data + index, data, len);
+    if (index + len > body->length) body->length = index + len;
+    body->data[body->length] = '\0';
+}
+
+bool ingestSequenceSnapshot() {
+    if (!pendingQueue || !queueLock) return false;
+
+    xSemaphoreTake(queueLock, portMAX_DELAY);
+    bool empty = uxQueueMessagesWaiting(pendingQueue) == 0;
+    if (empty) nodeSequenceSnapshot();
+    xSemaphoreGive(queueLock);
+    return empty;
+}
+
+bool ingestNextPending(SensorRecord &record, uint32_t waitMs) {
+    return pendingQueue && xQueueReceive(pendingQueue, &record, pdMS_TO_TICKS(waitMs)) == pdTRUE;
+}
+
+void ingestQueueStats(uint32_t &depth, uint32_t &highWater, uint32_t &dropped) {
+    depth = pendingQueue ? uxQueueMessagesWaiting(pendingQueue) : 0;
+    highWater = queueHighWater;
+    dropped = queueDropped;
+}
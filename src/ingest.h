@@ -0,0 +1,109 @@
+// ingest.h - Gemeinsamer Eingang für Messwerte aller Nodes
+//
+// Lokale Sensoren, /api/nodes/<id> und UDP liefern ihre Werte hier ab. Die
+// Registry wird sofort aktualisiert (für /sensors), der Datensatz landet in
+// einer Warteschlange, die der Ingest-Task abarbeitet (siehe pipeline.h).
+// Ist sie voll, wird die Messung abgewiesen (INGEST_QUEUE_FULL) - Nodes
+// senden dann später erneut, die Erzeuger warten nie.
+//
+// Nodes nummerieren ihre Messungen fortlaufend ("seq"). Je Node werden die
+// Bereiche schon angenommener Nummern gemerkt (siehe nodeSequenceIsNew()),
+// umsortierte Pakete und ein Puffer, den der Node neben neuen Messungen
+// nachschickt, gehen so nicht verloren; eine wiederholt gesendete Messung
+// wird ohne weitere Arbeit als "duplicate" quittiert und nicht noch einmal
+// geloggt. Einen neu begonnenen Zähler erkennt der Server am eigenen
+// "timestamp" der Messung; ohne seq (lokale Sensoren, alte Nodes) wird
+// nicht geprüft. Die Quittung nennt nur Nummern, die schon sicher im Log
+// stehen (nodeSequenceDurable()) - bis dahin behält der Node seinen Puffer.
+//
+// Messwerte, die älter sind als der neueste angenommene (Puffer eines Nodes
+// nach einem Ausfall), sortiert der storage-Task nachträglich ins Log ein
+// (sensorLogBackfill()). Als "late" abgelehnt wird nur, was mehr als
+// INGEST_BACKFILL_MAX_AGE vor der neuesten Messung desselben Nodes liegt -
+// ein Node, der nur seinen Puffer nachschickt, wird also nicht abgewiesen,
+// weil andere Nodes inzwischen weiter sind. Nodes schicken ihren Puffer
+// aufsteigend nach seq.
+#ifndef INGEST_H
+#define INGEST_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "sensor_log.h"
+#include "node_registry.h"
+
+#define INGEST_QUEUE_LENGTH 64
+#define INGEST_BODY_MAX 8192            // größter angenommener POST-Body in Byte
+#define INGEST_MAX_CLOCK_SKEW 60        // so viele Sekunden darf die Uhr eines Nodes vorgehen
+#define INGEST_BACKFILL_MAX_AGE (7 * 86400UL)   // so weit zurück wird nachgeliefert
+#define INGEST_NO_SEQUENCE 0xFFFFFFFFUL         // Messung ohne laufende Nummer
+
+enum IngestStatus {
+    INGEST_OK = 0,
+    INGEST_EMPTY,           // kein bekannter Kanal mit Zahlenwert
+    INGEST_LATE,            // älter als INGEST_BACKFILL_MAX_AGE vor dem neuesten Messwert des Nodes
+    INGEST_FUTURE,          // Zeitstempel liegt in der Zukunft
+    INGEST_QUEUE_FULL,      // vorübergehend, später noch einmal senden
+    INGEST_PARSE_ERROR,     // kein gültiges JSON, der Rest des Batches ist verloren
+    INGEST_DUPLICATE,       // seq schon angenommen, nichts zu tun
+    INGEST_INVALID          // nur Werte, die nicht endlich sind oder SENSOR_VALUE_MAX erreichen
+};
+
+// Ergebnis eines Batches, wird dem Node als Quittung zurückgeschickt
+struct IngestAck {
+    uint16_t accepted;
+    uint16_t duplicates;        // schon angenommen, zählen weder als accepted noch als rejected
+    uint16_t rejected;
+    int firstRejected;          // Position im Batch, -1 = alles angenommen
+    IngestStatus firstError;
+    int retryFrom;              // ab hier erneut senden (Warteschlange voll), -1 = nicht nötig
+    uint32_t nextSequence;      // darunter lückenlos sicher im Log (nodeSequenceNext()), 0 = keine bekannt
+};
+
+// POST-Body, der in mehreren Stücken ankommt. Wird mit malloc() angelegt,
+// damit ihn der Webserver als _tempObject der Anfrage wieder freigeben kann.
+struct IngestBody {
+    size_t capacity;
+    size_t length;
+    bool overflow;              // größer als INGEST_BODY_MAX
+    char data[1];
+};
+
+// Warteschlange anlegen; die neueste Messung je Node beginnt bei 0
+bool ingestBegin();
+
+// Werte eines Nodes übernehmen; kinds[i] gehört zu values[i]. timestamp 0 = jetzt,
+// seq = laufende Nummer beim Node. NaN, Inf und Beträge ab SENSOR_VALUE_MAX
+// werden verworfen, die übrigen Kanäle der Messung bleiben.
+IngestStatus ingestSample(uint8_t node, uint32_t timestamp, const uint8_t *kinds, const float *values, size_t count,
+                          uint32_t seq = INGEST_NO_SEQUENCE);
+
+// JSON-Objekt eines Nodes: {"temperature":21.5,"humidity":40,...}, optional
+// "timestamp" als Unix-Zeit und "seq". Unbekannte Schlüssel werden ignoriert.
+IngestStatus ingestJson(uint8_t node, JsonObjectConst sample);
+
+// Body mit einem JSON-Objekt, einem Array von Objekten oder NDJSON (ein
+// Objekt pro Zeile). Die Messungen werden einzeln gelesen, der Speicher-
+// bedarf hängt nicht von der Batchgröße ab.
+void ingestBatch(uint8_t node, const char *body, size_t len, IngestAck &ack);
+
+const char *ingestStatusName(IngestStatus status);
+
+// total = angekündigte Länge (0 = unbekannt). NULL ohne Speicher.
+IngestBody *ingestBodyCreate(size_t total);
+void ingestBodyAppend(IngestBody *body, const uint8_t *data, size_t len, size_t index);
+
+// Nächster noch nicht verarbeiteter Datensatz; wartet bis zu waitMs,
+// false wenn keiner kam
+bool ingestNextPending(SensorRecord &record, uint32_t waitMs = 0);
+
+// Nur aus dem Task, der ingestNextPending() aufruft, nachdem er alles
+// Abgeholte weitergegeben hat: ist die Warteschlange leer, merkt sich die
+// Registry die angenommenen laufenden Nummern (nodeSequenceSnapshot()) -
+// alles, was dazu gehört, ist dann unterwegs ins Log. false, solange noch
+// Messungen warten.
+bool ingestSequenceSnapshot();
+
+// Füllstand, höchster Füllstand und abgewiesene Messungen seit dem Start
+void ingestQueueStats(uint32_t &depth, uint32_t &highWater, uint32_t &dropped);
+
+#endif
@@ -0,0 +1,137 @@
+#include "json_writer.h"
+
+JsonWriter::JsonWriter(char *buffer, size_t capacity)
+    : buffer(capacity ? buffer : nullptr), capacity(buffer ? capacity : 0), len(0), overflow(false), depth(0) {
+    hasElements[0] = false;
+    if (this->capacity) buffer[0] = '\0';
+}
+
+void JsonWriter::write(const char *text, size_t count) {
+    if (buffer) {
+        // Platz für '\0' bleibt immer frei
+        size_t room = len < capacity ? capacity - 1 - len : 0;
+        size_t copy = count < room ? count : room;
+        memcpy(buffer + len, text, copy);
+        buffer[len + copy] = '\0';
+        if (copy < count) overflow = true;
+    }
+    // Ohne Puffer wird auch über das Ende hinaus gezählt, das ist die nötige Größe
+    len += count;
+    if (buffer && len >= capacity) len = capacity - 1;
+}
+
+// Komma vor jedem weiteren Element einer Ebene, dann ggf. der Schlüssel
+void JsonWriter::element(const char *key) {
+    if (hasElements[depth]) write(",", 1);
+    hasElements[depth] = true;
+
+    if (key) {
+        writeString(key);
+        write(":", 1);
+    }
+}
+
+void JsonWriter::writeString(const char *text) {
+    write("\"", 1);
+
+    const char *run = text;
+    for (const char *c = text; *c; c++) {
+        unsigned char ch = (unsigned char)*c;
+        if (ch >= 0x20 && ch != '"' && ch != '\\') continue;
+
+        // Unverändertes Stück davor am Stück schreiben
+        write(run, c - run);
+        run = c + 1;
+
+        char escaped[8];
+        switch (ch) {
+            case '"':  write("\\\"", 2); break;
+            case '\\': write("\\\\", 2); break;
+            case '\n': write("\\n", 2); break;
+            case '\r': write("\\r", 2); break;
+            case '\t': write("\\t", 2); break;
+            default:
+                snprintf(escaped, sizeof(escaped), "\\u%04x", ch);
+                write(escaped, 6);
+        }
+    }
+    write(run, strlen(run));
+
+    write("\"", 1);
+}
+
+void JsonWriter::beginObject(const char *key) {
+    element(key);
+    write("{", 1);
+
+    if (depth < JSON_WRITER_MAX_DEPTH) depth++;
+    else overflow = true;
+    hasElements[depth] = false;
+}
+
+void JsonWriter::endObject() {
+    if (depth > 0) depth--;
+    write("}", 1);
+}
+
+void JsonWriter::beginArray(const char *key) {
+    element(key);
+    write("[", 1);
+
+    if (depth < JSON_WRITER_MAX_DEPTH) depth++;
+    else overflow = true;
+    hasElements[depth] = false;
+}
+
+void JsonWriter::endArray() {
+    if (depth > 0) depth--;
+    write("]", 1);
+}
+
+void JsonWriter::addString(const char *key, const char *value) {
+    element(key);
+    writeString(value ? value : "");
+}
+
+void JsonWriter::addUnsigned(const char *key, unsigned long value) {
+    char text[24];
+    int count = snprintf(text, sizeof(text), "%lu", value);
+
+    element(key);
+    write(text, count);
+}
+
+void JsonWriter::addInt(const char *key, long value) {
+    char text[24];
+    int count = snprintf(text, sizeof(text), "%ld", value);
+
+    element(key);
+    write(text, count);
+}
+
+void JsonWriter::addFloat(const char *key, float value, int decimals) {
+    if (isnan(value) || isinf(value)) {
+        addNull(key);
+        return;
+    }
+
+    char text[48];
+    int count = snprintf(text, sizeof(text), "%.*f", decimals, value);
+    if (count < 0 || count >= (int)sizeof(text)) {
+        addNull(key);
+        return;
+    }
+
+    element(key);
+    write(text, count);
+}
+
+void JsonWriter::addBool(const char *key, bool value) {
+    element(key);
+    write(value ? "true" : "false");
+}
+
+void JsonWriter::addNull(const char *key) {
+    element(key);
+    write("null", 4);
+}
@@ -0,0 +1,62 @@
+// json_writer.h - JSON direkt in einen Puffer fester Größe schreiben
+//
+// Für die häufigen Antworten (/sensors, Ingest-Quittung, Live-Events) statt
+// JsonDocument + serializeJson(): kein Heap, keine Zwischenstruktur, Kommas
+// und Maskierung von Strings übernimmt der Writer.
+//
+//   char data[128];
+//   JsonWriter json(data, sizeof(data));
+//   json.beginObject();
+//   json.addString("node", "pico");
+//   json.beginObject("values");
+//   json.addFloat("temperature", 21.5f);
+//   json.endObject();
+//   json.endObject();
+//   if (!json.overflowed()) send(json.c_str(), json.length());
+//
+// Reicht der Platz nicht, wird abgeschnitten und overflowed() ist true - das
+// Ergebnis ist dann kein gültiges JSON. Ohne Puffer (nullptr, 0) wird nur
+// gezählt: length() ist danach die nötige Größe ohne '\0'.
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <Arduino.h>
+
+#define JSON_WRITER_MAX_DEPTH 8
+
+class JsonWriter {
+public:
+    JsonWriter(char *buffer, size_t capacity);
+
+    // key nur innerhalb von Objekten, in Arrays nullptr
+    void beginObject(const char *key = nullptr);
+    void endObject();
+    void beginArray(const char *key = nullptr);
+    void endArray();
+
+    void addString(const char *key, const char *value);
+    void addUnsigned(const char *key, unsigned long value);
+    void addInt(const char *key, long value);
+    void addFloat(const char *key, float value, int decimals = 2);  // NaN/Inf als null
+    void addBool(const char *key, bool value);
+    void addNull(const char *key);
+
+    const char *c_str() const { return buffer ? buffer : ""; }
+    size_t length() const { return len; }
+    bool overflowed() const { return overflow; }
+
+private:
+    void element(const char *key);
+    void write(const char *text, size_t count);
+    void write(const char *text) { write(text, strlen(text)); }
+    void writeString(const char *text);
+
+    char *buffer;
+    size_t capacity;
+    size_t len;
+    bool overflow;
+    uint8_t depth;
+    bool hasElements[JSON_WRITER_MAX_DEPTH + 1];    // Ebene hat schon ein Element, vor dem nächsten ein Komma
+};
+
+#endif
@@ -0,0 +1,66 @@
+#include "live_events.h"
+#include "node_registry.h"
+#include "json_writer.h"
+
+static AsyncEventSource events(LIVE_EVENTS_PATH);
+
+void liveEventsBegin(AsyncWebServer &server) {
+    events.onConnect([](AsyncEventSourceClient *client) {
+        // Wartezeit für das automatische Neuverbinden im Browser
+        client->send("hello", NULL, millis(), LIVE_EVENTS_RETRY_MS);
+    });
+    server.addHandler(&events);
+}
+
+size_t liveEventsClients() {
+    return events.count();
+}
+
+void liveEventsSample(const SensorRecord &record) {
+    if (events.count() == 0) return;
+
+    NodeInfo node;
+    if (!nodeGet(record.node, node)) return;
+
+    char data[256];
+    JsonWriter json(data, sizeof(data));
+    json.beginObject();
+    json.addString("node", node.id);
+    json.addUnsigned("ts", record.timestamp);
+
+    json.beginObject("values");
+    for (int slot = 0; slot < node.channelCount; slot++) {
+        if (record.valid & (1 << slot)) json.addFloat(channelKindName(node.channels[slot]), record.values[slot]);
+    }
+    json.endObject();
+    json.endObject();
+
+    if (json.overflowed()) return;
+    events.send(data, "sample", millis());
+}
+
+void liveEventsWeather(const WeatherState &weather) {
+    if (events.count() == 0) return;
+
+    // Platz auch für eine komplett maskierte Beschreibung
+    char data[64 + 6 * sizeof(weather.description)];
+    JsonWriter json(data, sizeof(data));
+    json.beginObject();
+    json.addString("weather", weather.description);
+    json.addUnsigned("updated", weather.fetchedAt);
+    json.endObject();
+
+    if (json.overflowed()) return;
+    events.send(data, "weather", millis());
+}
+
+void liveEventsAlert(const AlertStatus &status) {
+    if (events.count() == 0) return;
+
+    char data[256];
+    JsonWriter json(data, sizeof(data));
+    alertJsonWrite(json, status);
+
+    if (json.overflowed()) return;
+    events.send(data, "alert", millis());
+}
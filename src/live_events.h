@@ -0,0 +1,40 @@
+// live_events.h - Neue Messwerte per Server-Sent Events an das Dashboard
+//
+// Statt /sensors jede Minute abzufragen, hält das Dashboard eine Verbindung
+// auf /events offen. Jede geloggte Messung wird als kleines Delta verschickt,
+// nur mit den Kanälen, die sie enthält:
+//
+//   event: sample   data: {"node":"pico","ts":1760000000,"values":{"temperature":21.50}}
+//   event: weather  data: {"weather":"12C, leichter Regen","updated":1760000000}
+//   event: alert    data: {"rule":"keller_kalt","node":"keller","channel":"temperature",
+//                          "type":"below","active":true,"since":1760000000,"value":11.80}
+//
+// Gesendet wird aus dem ingest-Task (pipeline.h), die Ingest-Warteschlange ist
+// die einzige Quelle.
+#ifndef LIVE_EVENTS_H
+#define LIVE_EVENTS_H
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include "sensor_log.h"
+#include "weather.h"
+#include "alerts.h"
+
+#define LIVE_EVENTS_PATH "/events"
+#define LIVE_EVENTS_RETRY_MS 5000      // Browser verbindet sich nach Abbruch neu
+
+// Registriert /events am Server
+void liveEventsBegin(AsyncWebServer &server);
+
+// Delta einer neuen Messung an alle verbundenen Dashboards
+void liveEventsSample(const SensorRecord &record);
+
+// Neuer Wetterstand
+void liveEventsWeather(const WeatherState &weather);
+
+// Eine Alarm-Regel hat gewechselt (Handler für alertsBegin())
+void liveEventsAlert(const AlertStatus &status);
+
+size_t liveEventsClients();
+
+#endif
@@ -4,9 +4,7 @@
 #include "secrets.h"
 #include <WiFi.h>
 #include <ESPAsyncWebServer.h>
-#include <HTTPClient.h>
-#include <ArduinoJson.h>
-#include "webserver.h"
+#include "web_assets.h"
 #include <time.h>
 
 // Sensor libraries
@@ -14,11 +12,30 @@
 #include <Adafruit_Sensor.h>
 #include <Adafruit_BMP280.h>
 #include <Adafruit_AHTX0.h>
+#include "sensor_acquisition.h"
 
 // SD Card
 #include "FS.h"
 #include <SD.h>
 #include <SPI.h>
+#include "sensor_log.h"
+#include "history_stream.h"
+#include "history_query.h"
+#include "rollup.h"
+#include "channel_stats.h"
+#include "sample_ring.h"
+#include "weather.h"
+#include "node_registry.h"
+#include "ingest.h"
+#include "udp_ingest.h"
+#include "live_events.h"
+#include "alerts.h"
+#include "pipeline.h"
+#include "sensors_json.h"
+#include "json_writer.h"
+#include "metrics.h"
+#include "metrics_http.h"
+#include <memory>
 
 
 // Definitions for Sensors
@@ -32,18 +49,16 @@ float tempOffset = 0.0;
 float humScale   = 1.0;
 float humOffset  = 0.0;
 
-float temperature = 0.0;
-float humidity = 0.0;
-float pressure = 0.0;
+// Kanäle des ESP32-Nodes, in dieser Reihenfolge auch in den alten Logs
+const uint8_t localKinds[] = { KIND_TEMPERATURE, KIND_HUMIDITY, KIND_PRESSURE };
 
-// Defintions for second sensor
-float picoTemperature = 0.0;
-float picoHumidity = 0.0;
-float picoPressure = 0.0;
+// Node-Ingest: POST /api/nodes/<id>
+#define NODE_API_PREFIX "/api/nodes/"
 
-char response[256];
-unsigned long lastMeasurement = 0;
-const unsigned long measurementInterval = 60000; // 60 Sekunden
+// Abstand der lokalen Messungen
+#ifndef SENSOR_SAMPLE_INTERVAL_MS
+#define SENSOR_SAMPLE_INTERVAL_MS 60000     // 60 Sekunden
+#endif
 
 // WiFi credentials
 const char* ssid = WIFI_SSID;
@@ -56,77 +71,13 @@ AsyncWebServer server(80);
 #define SD_SCK 12
 #define SD_MISO 13
 #define SD_MOSI 11
-char dataString[128];
-
-char csvData[12000] = "";
-char line[128];
-
-char csvResponse[12000];
-
-// Weather API
-char weatherDescription[64] = "Loading...";
-float weatherTemp = 0.0;
-unsigned long lastWeatherUpdate = 0;
-const unsigned long weatherUpdateInterval = 6000000; // 100 Minuten
-
+#define SD_MAX_OPEN_FILES 10
 // Time
 char currentTime[32] = "Loading...";
 const char* ntpServer = "pool.ntp.org";
 const long gmtOffset_sec = 3600;
 const int daylightOffset_sec = 0;
 
-// Wetterdaten vom ESP32 abrufen
-void getWeatherData() {
-    if (WiFi.status() == WL_CONNECTED) {
-        HTTPClient http;
-        
-        char url[256];
-        snprintf(
-            url,
-            sizeof(url),
-            "http://api.openweathermap.org/data/2.5/weather?q=Mannheim&appid=%s&units=metric&lang=de",
-            WEATHER_API_KEY
-        );
-        
-        Serial.println("Hole Wetterdaten...");
-        http.begin(url);
-        int httpCode = http.GET();
-        
-        if (httpCode == 200) {
-            WiFiClient *stream = http.getStreamPtr();
-            
-            JsonDocument doc;
-            DeserializationError error = deserializeJson(doc, *stream);
-            
-            if (!error) {
-                weatherTemp = doc["main"]["temp"];
-                const char* description = doc["weather"][0]["description"];
-                snprintf(
-                    weatherDescription,
-                    sizeof(weatherDescription),
-                    "%dC, %s",
-                    (int)round(weatherTemp),
-                    description
-                );
-                
-                Serial.print("Wetter aktualisiert: ");
-                Serial.println(weatherDescription);
-            } else {
-                Serial.println("JSON Parse Fehler");
-                strncpy(weatherDescription, "Fehler beim Parsen", sizeof(weatherDescription));
-            }
-        } else {
-            Serial.print("HTTP Fehler: ");
-            Serial.println(httpCode);
-            strncpy(weatherDescription, "Nicht verfuegbar", sizeof(weatherDescription));
-        }
-        
-        http.end();
-    } else {
-        strncpy(weatherDescription, "Keine WiFi-Verbindung", sizeof(weatherDescription));
-    }
-}
-
 void getDateTime() {
     struct tm timeinfo;
     
@@ -140,48 +91,82 @@ void getDateTime() {
     strncpy(currentTime, formattedTime, sizeof(currentTime));
 }
 
-void logToSD() {
-    File logFile = SD.open("/sensor_log.csv", FILE_APPEND);
-
-    if (logFile) {
-        snprintf(
-            dataString,
-            sizeof(dataString),
-            "%s;%.2f;%.2f;%.2f;%.2f;%.2f;%.2f\n",
-            currentTime,
-            temperature,
-            humidity,
-            pressure,
-            picoTemperature,
-            picoHumidity,
-            picoPressure
-        );
-
-        logFile.print(dataString);
-        logFile.close();
-    } 
-    else {
-        Serial.println("Fehler beim Öffnen der Log-Datei!");
-    }
+// Fertige Messung der lokalen Sensoren übernehmen, läuft im acquisition-Task
+void handleLocalReading(const LocalReading &reading) {
+    float temperature = reading.temperature + tempOffset;
+    float humidity = reading.humidity * humScale + humOffset;
+
+    // Nur formatieren, getLocalTime() würde ohne NTP bis zu 5 s warten
+    char measuredAt[32];
+    time_t timestamp = reading.timestamp;
+    struct tm timeinfo;
+    localtime_r(&timestamp, &timeinfo);
+    strftime(measuredAt, sizeof(measuredAt), "%Y-%m-%dT%H:%M:%S", &timeinfo);
+
+    Serial.printf("Time: %s | Temp: %.2fC | Hum: %.2f%% | Pressure: %.2f hPa\n",
+                  measuredAt, temperature, humidity, reading.pressure);
+
+    // Wie jeder andere Node über den Ingest, geloggt wird im storage-Task
+    const float values[] = { temperature, humidity, reading.pressure };
+    ingestSample(NODE_LOCAL, reading.timestamp, localKinds, values, 3);
 }
 
-void getSensorData() {
-    sensors_event_t humEvent, tempEvent;
-    aht.getEvent(&humEvent, &tempEvent);
-    
-    temperature = tempEvent.temperature + tempOffset;
-    humidity = humEvent.relative_humidity * humScale + humOffset;
-    pressure = bmp.readPressure() / 100.0F;
+// Body-Stücke eines Node-POSTs sammeln, ausgewertet wird erst der ganze Body
+void collectNodeBody(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+    if (index == 0 && !request->_tempObject) request->_tempObject = ingestBodyCreate(total);
+    ingestBodyAppend((IngestBody *)request->_tempObject, data, len, index);
+}
 
-    getDateTime();
+// Batch eines Nodes übernehmen und quittieren:
+// {"status":"ok|partial|error","accepted":n,"rejected":m[,"duplicates":d][,"first_rejected":i,"error":"late"]
+//  [,"retry_from":i][,"next_seq":s]}
+// next_seq: alle laufenden Nummern darunter stehen lückenlos sicher im Log,
+// der Node kann sie aus seinem Puffer löschen. Es folgt dem Schreiben der
+// Karte (bis zu zwei SENSOR_LOG_FLUSH_INTERVAL), nicht der Annahme.
+void handleNodePost(AsyncWebServerRequest *request, const char *id) {
+    IngestBody *body = (IngestBody *)request->_tempObject;
+
+    if (!body || body->length == 0) {
+        request->send(400, "application/json", "{\"status\":\"error\",\"error\":\"Leerer Body\"}");
+        return;
+    }
+    if (body->overflow) {
+        request->send(413, "application/json", "{\"status\":\"error\",\"error\":\"Body zu groß\"}");
+        return;
+    }
+
+    int node = nodeRegister(id);
+    if (node < 0) {
+        Serial.println("Ungültige Node-ID oder Node-Liste voll");
+        request->send(400, "application/json", "{\"status\":\"error\",\"error\":\"Ungültige Node-ID\"}");
+        return;
+    }
 
-    Serial.print("Time: "); Serial.print(currentTime);
-    Serial.print(" | Temp: "); Serial.print(temperature);
-    Serial.print("C | Hum: "); Serial.print(humidity);
-    Serial.print("% | Pressure: "); Serial.print(pressure);
-    Serial.println(" hPa");
+    IngestAck ack;
+    ingestBatch(node, body->data, body->length, ack);
+
+    Serial.printf("POST von Node %s: %u angenommen, %u doppelt, %u abgelehnt\n",
+                  id, ack.accepted, ack.duplicates, ack.rejected);
+
+    char reply[192];
+    JsonWriter json(reply, sizeof(reply));
+    json.beginObject();
+    json.addString("status", ack.rejected == 0 ? "ok" : (ack.accepted ? "partial" : "error"));
+    json.addUnsigned("accepted", ack.accepted);
+    json.addUnsigned("rejected", ack.rejected);
+    if (ack.duplicates) json.addUnsigned("duplicates", ack.duplicates);
+    if (ack.firstRejected >= 0) {
+        json.addInt("first_rejected", ack.firstRejected);
+        json.addString("error", ingestStatusName(ack.firstError));
+    }
+    if (ack.retryFrom >= 0) json.addInt("retry_from", ack.retryFrom);
+    if (ack.nextSequence) json.addUnsigned("next_seq", ack.nextSequence);
+    json.endObject();
 
-    logToSD();
+    int code = 200;
+    if (ack.accepted == 0 && ack.rejected > 0) code = ack.firstError == INGEST_QUEUE_FULL ? 503 : 400;
+
+    request->send(code, "application/json", reply);
 }
 
 void setupSD() {
@@ -191,28 +176,38 @@ void setupSD() {
     SPI.begin(SD_SCK, SD_MISO, SD_MOSI, SD_CS);
     delay(100);
     
-    if (!SD.begin(SD_CS)) {
-        Serial.println("Couldn't mount SD Card!");
-        return;
+    // Log, Journal und Rollups halten ihre Dateien offen, dazu kommen Leser
+    bool mounted = SD.begin(SD_CS, SPI, 4000000, "/sd", SD_MAX_OPEN_FILES);
+    Serial.println(mounted ? "SD Card Ready!" : "Couldn't mount SD Card!");
+
+    // 1. Nodes laden (ohne Karte nur im RAM), der ESP32 hat immer Temperatur, Feuchte, Druck
+    nodeRegistryBegin(SD);
+    for (uint8_t kind : localKinds) nodeChannelSlot(NODE_LOCAL, (ChannelKind)kind, true);
+    nodeRegistryFlush(false);
+
+    if (!mounted) return;
+
+    // 2. Alte Formate einmalig übernehmen (Pico-Spalten -> Node "pico"), dann Binär-Log öffnen
+    if (sensorLogNeedsMigration(SD)) {
+        int pico = nodeRegister("pico");
+        for (uint8_t kind : localKinds) nodeChannelSlot(pico, (ChannelKind)kind, true);
+        nodeRegistryFlush(false);
+        sensorLogMigrate(SD, NODE_LOCAL, pico);
     }
-    
-    Serial.println("SD Card Ready!");
-    
-    // 2. Check data log file
-    const char* fileName = "/sensor_log.csv";
-
-    if (SD.exists(fileName)) {
-        Serial.println("Log-file already exists.");
-    } else {
-        File logFile = SD.open(fileName, FILE_WRITE);
-        if (logFile) {
-            logFile.println("Timestamp;Temperature;Humidity;Pressure;PicoTemperature;PicoHumidity;PicoPressure");
-            logFile.close();
-            Serial.println("Created log-file.");
-        } else {
-            Serial.println("Error creating log-file!");
-        }
+
+    if (!sensorLogBegin(SD)) {
+        Serial.println("Error opening log-file!");
+        return;
     }
+
+    // 3. Letzte Messungen in den RAM laden
+    sampleRingBegin();
+
+    // 4. Rollup-Stufen öffnen und ggf. aus dem Log nachziehen
+    rollupBegin(SD);
+
+    // 5. Statistik je Node und Kanal laden und ggf. aus dem Log nachziehen
+    channelStatsBegin(SD);
 }
 
 void setup() {
@@ -260,118 +255,265 @@ void setup() {
     // SD-Karte initialisieren
     setupSD();
 
-    // Erste Wetterdaten abrufen
-    getWeatherData();
+    // Alarm-Regeln von der Karte, Wechsel gehen an die Dashboards
+    alertsBegin(SD, liveEventsAlert);
 
-    // Erste Sesordaten abrufen
-    getSensorData();
+    // Gemeinsamer Eingang; verspätet ist eine Messung nur gegenüber ihrem eigenen Node
+    ingestBegin();
 
-    // Route für die Hauptseite - INLINE HTML
-    server.on("/", HTTP_GET, [](AsyncWebServerRequest *request) {
-        request->send(200, "text/html", index_html);
-    });
+    // Binärer Eingang für Nodes, die ohne HTTP senden
+    udpIngestBegin();
+
+    // Messen, Verarbeiten, Speichern und Wetter laufen ab jetzt in eigenen Tasks
+    acquisitionBegin(Wire, bmp, SENSOR_SAMPLE_INTERVAL_MS);
+    pipelineBegin(handleLocalReading);
+
+    // Dashboard: "/" und /assets/*, gzip aus dem Flash (siehe web/)
+    webAssetsBegin(server);
 
     // API-Endpunkt für Sensordaten
     server.on("/sensors", HTTP_GET, [](AsyncWebServerRequest *request) {
-        //getSensorData();
-        
-        // Wetter aktualisieren wenn nötig
-        if (millis() - lastWeatherUpdate > weatherUpdateInterval) {
-            getWeatherData();
-            lastWeatherUpdate = millis();
+        MetricsScope scope(METRIC_HTTP_SENSORS);
+
+        // Nur der zwischengespeicherte Stand, abgerufen wird im Wetter-Task
+        WeatherState weather;
+        weatherGet(weather);
+
+        // Neu serialisiert wird nur nach einer Änderung, sonst der fertige Body
+        std::shared_ptr<const SensorsBody> body = sensorsJsonCurrent(weather);
+        if (!body) {
+            request->send(503, "application/json", "{\"error\":\"Kein Speicher\"}");
+            return;
+        }
+
+        // Dashboard hat diesen Stand schon
+        if (request->hasHeader("If-None-Match")
+            && strstr(request->header("If-None-Match").c_str(), body->etag)) {
+            AsyncWebServerResponse *response = request->beginResponse(304);
+            response->addHeader("ETag", body->etag);
+            response->addHeader("Cache-Control", "no-cache");
+            request->send(response);
+            return;
         }
-        
-        JsonDocument doc;
-        doc["temperature"] = temperature;
-        doc["humidity"] = humidity;
-        doc["pressure"] = pressure;
-        doc["pico_temperature"] = picoTemperature;
-        doc["pico_humidity"] = picoHumidity;
-        doc["pico_pressure"] = picoPressure;
-        doc["weather"] = weatherDescription;
-        doc["timestamp"] = currentTime;
-        
-        serializeJson(doc, response);
-        
-        request->send(200, "application/json", response);
+
+        // Ohne Kopie aus dem Cache; die Antwort hält ihren Stand, bis sie gesendet ist
+        AsyncWebServerResponse *response = request->beginResponse("application/json", body->length,
+            [body](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+                size_t len = body->length - index;
+                if (len > maxLen) len = maxLen;
+                memcpy(buffer, body->json.get() + index, len);
+                return len;
+            });
+        response->addHeader("ETag", body->etag);
+        response->addHeader("Cache-Control", "no-cache");
+        request->send(response);
     });
     
+    // Tasks und Queues der Pipeline: Füllstände, Verluste, Stack-Reserven
+    server.on("/system", HTTP_GET, [](AsyncWebServerRequest *request) {
+        PipelineStats stats;
+        pipelineStats(stats);
+
+        AsyncResponseStream *response = request->beginResponseStream("application/json");
+        response->printf("{\"uptime\":%lu,\"heap_free\":%lu,\"heap_min\":%lu,\"tasks\":[",
+                         millis() / 1000, (unsigned long)ESP.getFreeHeap(), (unsigned long)ESP.getMinFreeHeap());
+
+        for (size_t i = 0; i < stats.taskCount; i++) {
+            const PipelineTaskStats &task = stats.tasks[i];
+            response->printf("%s{\"name\":\"%s\",\"core\":%d,\"priority\":%lu,\"stack\":%lu,\"stack_free\":%lu}",
+                             i ? "," : "", task.name, task.core, (unsigned long)task.priority,
+                             (unsigned long)task.stackSize, (unsigned long)task.stackFree);
+        }
+
+        response->print("],\"queues\":[");
+        for (size_t i = 0; i < stats.queueCount; i++) {
+            const PipelineQueueStats &queue = stats.queues[i];
+            response->printf("%s{\"name\":\"%s\",\"depth\":%lu,\"capacity\":%lu,\"high_water\":%lu,\"dropped\":%lu}",
+                             i ? "," : "", queue.name, (unsigned long)queue.depth, (unsigned long)queue.capacity,
+                             (unsigned long)queue.highWater, (unsigned long)queue.dropped);
+        }
+        response->print("]}");
+
+        request->send(response);
+    });
+
+    // Min, max, Mittel und Varianz je Kanal für heute, diese Woche und gesamt
+    // ?node=   nur dieser Node, sonst alle
+    server.on("/stats", HTTP_GET, [](AsyncWebServerRequest *request) {
+        int only = -1;
+        if (request->hasParam("node")) {
+            only = nodeFind(request->getParam("node")->value().c_str());
+            if (only < 0) {
+                request->send(404, "application/json", "{\"error\":\"Unbekannter Node\"}");
+                return;
+            }
+        }
+
+        uint32_t now = time(nullptr);
+        uint8_t total = nodeCount();
+
+        // Ein Node nach dem anderen, Puffer statisch wie bei /alerts
+        static char item[2560];
+
+        AsyncResponseStream *response = request->beginResponseStream("application/json");
+        if (only < 0) response->print("{\"nodes\":[");
+
+        bool first = true;
+        for (uint8_t node = 0; node < total; node++) {
+            if (only >= 0 && node != only) continue;
+
+            JsonWriter json(item, sizeof(item));
+            channelStatsJsonWrite(json, node, now);
+            if (json.overflowed() || json.length() == 0) continue;
+
+            if (!first) response->print(",");
+            response->print(json.c_str());
+            first = false;
+        }
+
+        if (only < 0) response->print("]}");
+        else if (first) response->print("{}");
+
+        request->send(response);
+    });
+
+    // Alle Alarm-Regeln mit ihrem Stand; Wechsel kommen danach über /events
+    server.on("/alerts", HTTP_GET, [](AsyncWebServerRequest *request) {
+        // Nicht auf den Stack von AsyncTCP, der arbeitet Anfragen ohnehin nacheinander ab
+        static AlertStatus rules[ALERT_MAX_RULES];
+        uint8_t total = alertsSnapshot(rules);
+
+        AsyncResponseStream *response = request->beginResponseStream("application/json");
+        response->print("{\"alerts\":[");
+        for (uint8_t i = 0; i < total; i++) {
+            char item[256];
+            JsonWriter json(item, sizeof(item));
+            alertJsonWrite(json, rules[i]);
+            if (i) response->print(",");
+            response->print(json.c_str());
+        }
+        response->print("]}");
+
+        request->send(response);
+    });
+
     server.onNotFound([](AsyncWebServerRequest *request) {
         request->send(404, "text/plain", "Nicht gefunden");
     });
     
     server.on("/sd-data", HTTP_GET, [](AsyncWebServerRequest *request) {
-        csvData[0] = '\0';   // Buffer reset
-        File file = SD.open("/sensor_log.csv", FILE_READ);
+        unsigned long started = micros();
 
-        if (!file) {
+        if (!sensorLogReady()) {
             request->send(500, "application/json", "{\"error\":\"Log-Datei nicht lesbar\"}");
             return;
         }
 
-        // Letzte 100 Zeilen lesen
-        int lineCount = 0;
-
-        while (file.available() && lineCount < 100) {
-
-            size_t len = file.readBytesUntil('\n', line, sizeof(line)-1);
-            line[len] = '\0';
-
-            if (strncmp(line, "Timestamp", 9) == 0 || strlen(line) < 10) continue;
-
-            strncat(csvData, line, sizeof(csvData) - strlen(csvData) - 2);
-            strncat(csvData, "\n", sizeof(csvData) - strlen(csvData) - 1);
-
-            lineCount++;
+        // ?node=          Node-ID (Standard "esp32")
+        // ?n=             letzte n Datensätze (Standard 100, höchstens 1000)
+        // ?since=         nur was seit dem Cursor "next" einer früheren Antwort dazukam
+        // ?from=&to=      Zeitbereich als Unix-Zeit
+        // ?points=&agg=   auf höchstens points Punkte reduzieren (min|max|avg|lttb)
+        // ?ch=            Kanal für lttb, z.B. "humidity"
+        HistoryQuery query;
+        historyQueryInit(query);
+
+        if (request->hasParam("node")) {
+            int node = nodeFind(request->getParam("node")->value().c_str());
+            if (node < 0) {
+                request->send(404, "application/json", "{\"error\":\"Unbekannter Node\"}");
+                return;
+            }
+            query.node = node;
         }
 
-        JsonDocument doc;
-        doc["status"] = "ok";
-        doc["lines"] = lineCount;
-        doc["data"] = csvData;
+        if (request->hasParam("n")) {
+            long n = request->getParam("n")->value().toInt();
+            if (n > 0) query.tail = n < HISTORY_MAX_TAIL ? n : HISTORY_MAX_TAIL;
+        }
+        if (request->hasParam("since")) {
+            query.since = strtoul(request->getParam("since")->value().c_str(), NULL, 10);
+        }
+        if (request->hasParam("from")) {
+            query.from = strtoul(request->getParam("from")->value().c_str(), NULL, 10);
+        }
+        if (request->hasParam("to")) {
+            query.to = strtoul(request->getParam("to")->value().c_str(), NULL, 10);
+        }
+        if (request->hasParam("points") || request->hasParam("agg")) {
+            query.points = HISTORY_DEFAULT_POINTS;
+        }
+        if (request->hasParam("points")) {
+            long points = request->getParam("points")->value().toInt();
+            if (points > 0) query.points = points < HISTORY_MAX_POINTS ? points : HISTORY_MAX_POINTS;
+        }
+        if (request->hasParam("agg")
+            && !historyAggFromName(request->getParam("agg")->value().c_str(), query.agg)) {
+            request->send(400, "application/json", "{\"error\":\"Unbekannte Aggregation\"}");
+            return;
+        }
+        if (request->hasParam("ch")) {
+            int kind = channelKindFromName(request->getParam("ch")->value().c_str());
+            query.channel = kind < 0 ? -1 : nodeChannelSlot(query.node, (ChannelKind)kind, false);
+            if (query.channel < 0) {
+                request->send(400, "application/json", "{\"error\":\"Unbekannter Kanal\"}");
+                return;
+            }
+        }
 
-        serializeJson(doc, csvResponse);
-        request->send(200, "application/json", csvResponse);
+        // Antwort wird direkt aus der Datei in den Socket gestreamt,
+        // der Zustand lebt genau so lange wie die Antwort
+        uint32_t next;
+        std::unique_ptr<RecordSource> source = historyOpen(query, &next);
+        std::shared_ptr<HistoryStream> stream = std::make_shared<HistoryStream>(std::move(source), query.node, next);
+
+        // Gemessen wird bis zum letzten Stück, das ist die Wartezeit im Dashboard
+        bool done = false;
+        request->sendChunked("application/json", [stream, started, done](uint8_t *buffer, size_t maxLen, size_t index) mutable -> size_t {
+            size_t len = stream->read(buffer, maxLen);
+            if (len == 0 && !done) {
+                done = true;
+                metricsObserve(METRIC_HTTP_SD_DATA, micros() - started);
+            }
+            return len;
+        });
     });
 
-    // Pico W Daten empfangen (HTTP POST JSON)
-    server.on("/api/pico", HTTP_POST, 
+    // Messwerte eines Nodes empfangen (HTTP POST JSON): /api/nodes/<id>
+    // Ein Objekt, ein Array von Objekten oder NDJSON, jeweils optional mit "timestamp".
+    // Der Handler für "/api/nodes" greift auch für alle Pfade darunter.
+    server.on("/api/nodes", HTTP_POST,
         [](AsyncWebServerRequest *request) {
-            request->send(200, "application/json", "{\"status\":\"ok\"}");
+            MetricsScope scope(METRIC_HTTP_API_NODES);
+            const String &url = request->url();
+            size_t prefix = strlen(NODE_API_PREFIX);
+            handleNodePost(request, url.length() > prefix ? url.c_str() + prefix : "");
         },
         NULL,
-        [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total)   {
-            // JSON-String bauen
-            Serial.print("Pico POST empfangen: ");
-            Serial.write(data, len);
-            Serial.println();
-
-            // ArduinoJson parsen
-            JsonDocument doc;
-            DeserializationError error = deserializeJson(doc, data, len);
-
-            if (!error) {
-                picoTemperature = doc["temperature"] | 0.0;
-                picoHumidity = doc["humidity"] | 0.0;
-                picoPressure = doc["pressure"] | 0.0;
-
-                Serial.printf("Pico: T=%.1f°C H=%.1f%% P=%.1f hPa\n", 
-                             picoTemperature, picoHumidity, picoPressure);
-            } else {
-                Serial.println("JSON Parse Fehler vom Pico");
-            }
-        }
+        collectNodeBody
+    );
+
+    // Alter Endpunkt des Pico W, entspricht /api/nodes/pico
+    server.on("/api/pico", HTTP_POST,
+        [](AsyncWebServerRequest *request) {
+            MetricsScope scope(METRIC_HTTP_API_PICO);
+            handleNodePost(request, "pico");
+        },
+        NULL,
+        collectNodeBody
     );
 
+    // Live-Updates für das Dashboard
+    liveEventsBegin(server);
+
+    // Prometheus-Abruf: Latenzen, SD, Ingest je Node, Heap, WiFi, Wetter
+    metricsHttpBegin(server);
+
     server.begin();
     Serial.println("HTTP-Server gestartet");
 }
 
 void loop() {
-
-    if (millis() - lastMeasurement > measurementInterval) {
-        lastMeasurement = millis();
-        getSensorData();
-    }
-
+    // Alles läuft in den Tasks aus pipeline.h
+    vTaskDelete(NULL);
 }
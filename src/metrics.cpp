@@ -0,0 +1,98 @@
+#include "metrics.h"
+
+static const uint32_t bucketBounds[METRICS_BUCKETS] = {
+    500, 1000, 2500, 5000, 10000, 25000, 50000, 100000,
+    250000, 500000, 1000000, 2500000, 5000000, 10000000
+};
+
+// Name, Hilfetext und Labels je Histogramm; Histogramme mit gleichem Namen
+// stehen hintereinander und bekommen HELP/TYPE nur einmal
+struct TimerInfo {
+    const char *name;
+    const char *help;
+    const char *labels;
+};
+
+static const TimerInfo timerInfo[METRIC_TIMERS] = {
+    { "homeserver_http_request_duration_seconds", "Zeit im HTTP-Handler", "route=\"/\"" },
+    { "homeserver_http_request_duration_seconds", nullptr, "route=\"/sensors\"" },
+    { "homeserver_http_request_duration_seconds", nullptr, "route=\"/sd-data\"" },
+    { "homeserver_http_request_duration_seconds", nullptr, "route=\"/api/pico\"" },
+    { "homeserver_http_request_duration_seconds", nullptr, "route=\"/api/nodes\"" },
+    { "homeserver_sd_operation_duration_seconds", "Dauer eines SD-Zugriffs", "op=\"read\"" },
+    { "homeserver_sd_operation_duration_seconds", nullptr, "op=\"write\"" },
+    { "homeserver_weather_fetch_duration_seconds", "Dauer eines Wetterabrufs", nullptr },
+};
+
+static MetricsHistogram histograms[METRIC_TIMERS];
+static uint32_t counters[METRIC_COUNTERS];
+
+static portMUX_TYPE metricsMux = portMUX_INITIALIZER_UNLOCKED;
+
+void metricsObserve(MetricsTimer timer, uint32_t micros) {
+    int bucket = 0;
+    while (bucket < METRICS_BUCKETS && micros > bucketBounds[bucket]) bucket++;
+
+    portENTER_CRITICAL(&metricsMux);
+    MetricsHistogram &histogram = histograms[timer];
+    if (bucket < METRICS_BUCKETS) histogram.buckets[bucket]++;
+    histogram.count++;
+    histogram.sumMicros += micros;
+    portEXIT_CRITICAL(&metricsMux);
+}
+
+void metricsCount(MetricsCounter counter) {
+    portENTER_CRITICAL(&metricsMux);
+    counters[counter]++;
+    portEXIT_CRITICAL(&metricsMux);
+}
+
+void metricsHistogram(MetricsTimer timer, MetricsHistogram &histogram) {
+    portENTER_CRITICAL(&metricsMux);
+    histogram = histograms[timer];
+    portEXIT_CRITICAL(&metricsMux);
+}
+
+uint32_t metricsCounter(MetricsCounter counter) {
+    portENTER_CRITICAL(&metricsMux);
+    uint32_t value = counters[counter];
+    portEXIT_CRITICAL(&metricsMux);
+    return value;
+}
+
+static void writeHistogram(Print &out, MetricsTimer timer) {
+    const TimerInfo &info = timerInfo[timer];
+    const char *labels = info.labels ? info.labels : "";
+    const char *separator = info.labels ? "," : "";
+
+    if (info.help) {
+        out.printf("# HELP %s %s\n# TYPE %s histogram\n", info.name, info.help, info.name);
+    }
+
+    MetricsHistogram histogram;
+    metricsHistogram(timer, histogram);
+
+    uint32_t cumulative = 0;
+    for (int i = 0; i < METRICS_BUCKETS; i++) {
+        cumulative += histogram.buckets[i];
+        out.printf("%s_bucket{%s%sle=\"%g\"} %lu\n", info.name, labels, separator,
+                   bucketBounds[i] / 1e6, (unsigned long)cumulative);
+    }
+    out.printf("%s_bucket{%s%sle=\"+Inf\"} %lu\n", info.name, labels, separator, (unsigned long)histogram.count);
+
+    const char *open = info.labels ? "{" : "";
+    const char *close = info.labels ? "}" : "";
+    out.printf("%s_sum%s%s%s %.6f\n", info.name, open, labels, close, histogram.sumMicros / 1e6);
+    out.printf("%s_count%s%s%s %lu\n", info.name, open, labels, close, (unsigned long)histogram.count);
+}
+
+void metricsWrite(Print &out) {
+    for (int timer = 0; timer < METRIC_TIMERS; timer++) writeHistogram(out, (MetricsTimer)timer);
+
+    out.printf("# HELP homeserver_weather_fetches_total Wetterabrufe nach Ergebnis\n"
+               "# TYPE homeserver_weather_fetches_total counter\n"
+               "homeserver_weather_fetches_total{result=\"ok\"} %lu\n"
+               "homeserver_weather_fetches_total{result=\"error\"} %lu\n",
+               (unsigned long)metricsCounter(METRIC_WEATHER_OK),
+               (unsigned long)metricsCounter(METRIC_WEATHER_FAILED));
+}
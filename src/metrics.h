@@ -0,0 +1,68 @@
+// metrics.h - Zähler und Latenz-Histogramme für /metrics (Prometheus-Text)
+//
+// Erfasst wird an festen Stellen mit festen IDs: HTTP-Handler, SD-Zugriffe
+// (RecordFile, Journal) und der Wetterabruf. metricsObserve()/metricsCount()
+// zählen nur in statische Felder unter einem kurzen Spinlock - kein malloc,
+// kein String, auch aus ISR-fernen Tasks beider Kerne aufrufbar.
+//
+// HTTP-Zeiten sind die Zeit im Handler, also wie lange der AsyncTCP-Task
+// blockiert war; bei /sd-data vom Handler bis das letzte Stück der Antwort
+// erzeugt ist (abgewiesene Abfragen und abgebrochene Antworten fehlen dort).
+// Die Anzahl Anfragen je Route steht in <name>_count des Histogramms.
+//
+// Geräteabhängige Werte (Heap, PSRAM, RSSI, Tasks) ergänzt metrics_http.cpp
+// beim Abruf; dieses Modul läuft auch in der native-Umgebung.
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <Arduino.h>
+
+enum MetricsTimer {
+    METRIC_HTTP_INDEX = 0,          // "/"
+    METRIC_HTTP_SENSORS,
+    METRIC_HTTP_SD_DATA,
+    METRIC_HTTP_API_PICO,
+    METRIC_HTTP_API_NODES,
+    METRIC_SD_READ,                 // ein Lesezugriff auf ein RecordFile (Block oder Suche)
+    METRIC_SD_WRITE,                // ein Schreibzugriff inkl. flush (Log, Journal, Rollups)
+    METRIC_WEATHER_FETCH,           // ein Abruf, erfolgreich oder nicht
+    METRIC_TIMERS
+};
+
+enum MetricsCounter {
+    METRIC_WEATHER_OK = 0,
+    METRIC_WEATHER_FAILED,
+    METRIC_COUNTERS
+};
+
+// Obere Grenzen der Buckets in Mikrosekunden, von 0,5 ms bis 10 s
+#define METRICS_BUCKETS 14
+
+struct MetricsHistogram {
+    uint32_t buckets[METRICS_BUCKETS];      // je Bucket, nicht kumuliert
+    uint32_t count;                         // inklusive Werte über dem letzten Bucket
+    uint64_t sumMicros;
+};
+
+void metricsObserve(MetricsTimer timer, uint32_t micros);
+void metricsCount(MetricsCounter counter);
+
+// Konsistente Kopie eines Histogramms bzw. Zählers
+void metricsHistogram(MetricsTimer timer, MetricsHistogram &histogram);
+uint32_t metricsCounter(MetricsCounter counter);
+
+// Schreibt alle Histogramme und Zähler im Prometheus-Textformat
+void metricsWrite(Print &out);
+
+// Misst die Zeit bis zum Ende des Blocks:  MetricsScope scope(METRIC_SD_READ);
+class MetricsScope {
+public:
+    explicit MetricsScope(MetricsTimer timer) : timer(timer), started(micros()) {}
+    ~MetricsScope() { metricsObserve(timer, micros() - started); }
+
+private:
+    MetricsTimer timer;
+    uint32_t started;
+};
+
+#endif
@@ -0,0 +1,93 @@
+#include "metrics_http.h"
+#include "metrics.h"
+#include "node_registry.h"
+#include "pipeline.h"
+#include "live_events.h"
+#include "alerts.h"
+#include "weather.h"
+#include "sensor_acquisition.h"
+#include <ESPAsyncWebServer.h>
+#include <WiFi.h>
+
+static void writeGauge(Print &out, const char *name, const char *type, const char *help, unsigned long value) {
+    out.printf("# HELP %s %s\n# TYPE %s %s\n%s %lu\n", name, help, name, type, name, value);
+}
+
+static void writeDevice(Print &out) {
+    writeGauge(out, "homeserver_uptime_seconds", "counter", "Sekunden seit dem Start", millis() / 1000);
+    writeGauge(out, "homeserver_heap_free_bytes", "gauge", "Freier Heap", ESP.getFreeHeap());
+    writeGauge(out, "homeserver_heap_min_free_bytes", "gauge", "Kleinster freier Heap seit dem Start", ESP.getMinFreeHeap());
+    writeGauge(out, "homeserver_heap_largest_free_block_bytes", "gauge", "Größter zusammenhängender freier Block", ESP.getMaxAllocHeap());
+    writeGauge(out, "homeserver_psram_size_bytes", "gauge", "PSRAM gesamt, 0 = keins", ESP.getPsramSize());
+    writeGauge(out, "homeserver_psram_free_bytes", "gauge", "PSRAM frei", ESP.getFreePsram());
+
+    bool connected = WiFi.status() == WL_CONNECTED;
+    writeGauge(out, "homeserver_wifi_connected", "gauge", "1 = mit dem Access Point verbunden", connected ? 1 : 0);
+    out.printf("# HELP homeserver_wifi_rssi_dbm Empfangsstärke\n# TYPE homeserver_wifi_rssi_dbm gauge\n"
+               "homeserver_wifi_rssi_dbm %d\n", connected ? WiFi.RSSI() : 0);
+}
+
+static void writeNodes(Print &out) {
+    out.print("# HELP homeserver_ingest_samples_total Angenommene Messungen je Node seit dem Start\n"
+              "# TYPE homeserver_ingest_samples_total counter\n");
+
+    // Einzeln über den Seqlock kopieren, ohne Platz für alle Nodes zu brauchen
+    uint8_t count = nodeCount();
+    NodeInfo node;
+    for (uint8_t i = 0; i < count; i++) {
+        if (nodeGet(i, node)) out.printf("homeserver_ingest_samples_total{node=\"%s\"} %lu\n", node.id, (unsigned long)node.samples);
+    }
+
+    out.print("# HELP homeserver_node_last_seen_timestamp_seconds Unix-Zeit der letzten Messung\n"
+              "# TYPE homeserver_node_last_seen_timestamp_seconds gauge\n");
+    for (uint8_t i = 0; i < count; i++) {
+        if (nodeGet(i, node)) out.printf("homeserver_node_last_seen_timestamp_seconds{node=\"%s\"} %lu\n", node.id, (unsigned long)node.lastSeen);
+    }
+}
+
+static void writePipeline(Print &out) {
+    PipelineStats stats;
+    pipelineStats(stats);
+
+    out.print("# HELP homeserver_queue_depth Einträge in der Warteschlange\n# TYPE homeserver_queue_depth gauge\n");
+    for (size_t i = 0; i < stats.queueCount; i++) {
+        out.printf("homeserver_queue_depth{queue=\"%s\"} %lu\n", stats.queues[i].name, (unsigned long)stats.queues[i].depth);
+    }
+    out.print("# HELP homeserver_queue_high_water Höchster Füllstand seit dem Start\n# TYPE homeserver_queue_high_water gauge\n");
+    for (size_t i = 0; i < stats.queueCount; i++) {
+        out.printf("homeserver_queue_high_water{queue=\"%s\"} %lu\n", stats.queues[i].name, (unsigned long)stats.queues[i].highWater);
+    }
+    out.print("# HELP homeserver_queue_dropped_total Verworfene Einträge (Queue voll)\n# TYPE homeserver_queue_dropped_total counter\n");
+    for (size_t i = 0; i < stats.queueCount; i++) {
+        out.printf("homeserver_queue_dropped_total{queue=\"%s\"} %lu\n", stats.queues[i].name, (unsigned long)stats.queues[i].dropped);
+    }
+    out.print("# HELP homeserver_task_stack_free_bytes Kleinste Stack-Reserve seit dem Start\n# TYPE homeserver_task_stack_free_bytes gauge\n");
+    for (size_t i = 0; i < stats.taskCount; i++) {
+        out.printf("homeserver_task_stack_free_bytes{task=\"%s\"} %lu\n", stats.tasks[i].name, (unsigned long)stats.tasks[i].stackFree);
+    }
+}
+
+static void writeServices(Print &out) {
+    writeGauge(out, "homeserver_sse_clients", "gauge", "Offene /events-Verbindungen", liveEventsClients());
+    writeGauge(out, "homeserver_alerts_active", "gauge", "Aktive Alarme (alerts.h)", alertsActive());
+    writeGauge(out, "homeserver_acquisition_errors_total", "counter", "Fehlgeschlagene lokale Messungen", acquisitionErrors());
+
+    WeatherState weather;
+    weatherGet(weather);
+    writeGauge(out, "homeserver_weather_last_success_timestamp_seconds", "gauge",
+               "Unix-Zeit des letzten erfolgreichen Wetterabrufs, 0 = noch nie", weather.fetchedAt);
+}
+
+void metricsHttpBegin(AsyncWebServer &server) {
+    server.on("/metrics", HTTP_GET, [](AsyncWebServerRequest *request) {
+        AsyncResponseStream *response = request->beginResponseStream("text/plain; version=0.0.4");
+
+        metricsWrite(*response);
+        writeDevice(*response);
+        writeNodes(*response);
+        writePipeline(*response);
+        writeServices(*response);
+
+        request->send(response);
+    });
+}
@@ -0,0 +1,17 @@
+// metrics_http.h - GET /metrics im Prometheus-Textformat
+//
+// Neben den Histogrammen und Zählern aus metrics.h werden beim Abruf gelesen:
+// Heap (frei, Minimum, größter Block), PSRAM, WiFi-RSSI, Messungen je Node
+// (Ingest-Rate über rate()), Queues und Stack-Reserven der Pipeline,
+// Dashboard-Verbindungen und der letzte erfolgreiche Wetterabruf.
+// Nur der Abruf selbst allokiert (Antwortpuffer), die Erfassung nicht.
+#ifndef METRICS_HTTP_H
+#define METRICS_HTTP_H
+
+#include <Arduino.h>
+
+class AsyncWebServer;
+
+void metricsHttpBegin(AsyncWebServer &server);
+
+#endif
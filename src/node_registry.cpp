@@ -0,0 +1,447 @@
+#include "node_registry.h"
+#include "seqlock.h"
+
+static const char *const kindNames[CHANNEL_KINDS] = {
+    "temperature",
+    "humidity",
+    "pressure",
+    "co2",
+    "light",
+    "battery"
+};
+
+static NodeInfo nodes[NODE_MAX];
+static uint8_t count = 0;
+static fs::FS *registryFs = nullptr;
+// /nodes.txt schreibt nur nodeRegistryFlush(), die anderen markieren nur
+static bool layoutDirty = false;        // Node oder Kanal dazugekommen
+static bool sequencesDirty = false;
+
+// Laufende Nummern: sicher im Log (quittiert und in /nodes.txt), gemerkter
+// Stand für nodeSequenceDurable() und ein Zähler je Node, der bei jedem
+// Neubeginn steigt - ein älterer Stand gilt dann nicht mehr
+static NodeSequences durable[NODE_MAX];
+static NodeSequences snapshot[NODE_MAX];
+static uint8_t epochs[NODE_MAX];
+static uint8_t snapshotEpochs[NODE_MAX];
+static uint8_t snapshotCount = 0;
+
+// Schreiber schließen sich über registryMux aus, Leser kopieren über
+// registrySeq ohne Sperre (nodeGet, nodeSnapshot)
+static portMUX_TYPE registryMux = portMUX_INITIALIZER_UNLOCKED;
+static SeqLock registrySeq;
+
+const char *channelKindName(uint8_t kind) {
+    return kind < CHANNEL_KINDS ? kindNames[kind] : "?";
+}
+
+int channelKindFromName(const char *name) {
+    for (int i = 0; i < CHANNEL_KINDS; i++) {
+        if (strcmp(name, kindNames[i]) == 0) return i;
+    }
+    return -1;
+}
+
+bool nodeIdValid(const char *id) {
+    size_t len = strlen(id);
+    if (len == 0 || len >= NODE_ID_LEN) return false;
+
+    for (size_t i = 0; i < len; i++) {
+        char c = id[i];
+        if (!((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '_' || c == '-')) return false;
+    }
+    return true;
+}
+
+// Nur unter registryMux aufrufen
+static int findLocked(const char *id) {
+    for (int i = 0; i < count; i++) {
+        if (strcmp(nodes[i].id, id) == 0) return i;
+    }
+    return -1;
+}
+
+// Nur unter registryMux aufrufen
+static int addLocked(const char *id) {
+    if (count >= NODE_MAX) return -1;
+
+    registrySeq.writeBegin();
+    NodeInfo &node = nodes[count];
+    memset(&node, 0, sizeof(node));
+    strncpy(node.id, id, NODE_ID_LEN - 1);
+    memset(&durable[count], 0, sizeof(durable[count]));
+    epochs[count] = 0;
+    int index = count++;
+    registrySeq.writeEnd();
+
+    return index;
+}
+
+static void saveRegistry() {
+    if (!registryFs) return;
+
+    // Erst kopieren, die SD-Zugriffe laufen ohne Lock
+    char ids[NODE_MAX][NODE_ID_LEN];
+    uint8_t channels[NODE_MAX][NODE_MAX_CHANNELS];
+    uint8_t channelCounts[NODE_MAX];
+    NodeSequences sequences[NODE_MAX];
+    uint8_t total;
+
+    portENTER_CRITICAL(&registryMux);
+    total = count;
+    for (int i = 0; i < total; i++) {
+        memcpy(ids[i], nodes[i].id, NODE_ID_LEN);
+        memcpy(channels[i], nodes[i].channels, NODE_MAX_CHANNELS);
+        channelCounts[i] = nodes[i].channelCount;
+        sequences[i] = durable[i];
+    }
+    bool layoutWasDirty = layoutDirty;
+    layoutDirty = false;
+    sequencesDirty = false;
+    portEXIT_CRITICAL(&registryMux);
+
+    File file = registryFs->open(NODE_REGISTRY_FILE, FILE_WRITE);
+    if (!file) {
+        Serial.println("Fehler beim Speichern der Node-Liste!");
+
+        // Beim nächsten nodeRegistryFlush() noch einmal
+        portENTER_CRITICAL(&registryMux);
+        layoutDirty |= layoutWasDirty;
+        sequencesDirty = true;
+        portEXIT_CRITICAL(&registryMux);
+        return;
+    }
+
+    for (int i = 0; i < total; i++) {
+        file.print(ids[i]);
+        file.print(";");
+        for (int c = 0; c < channelCounts[i]; c++) {
+            if (c > 0) file.print(",");
+            file.print(channelKindName(channels[i][c]));
+        }
+        if (sequences[i].count) {
+            char sequence[32];
+            for (int r = 0; r < sequences[i].count; r++) {
+                snprintf(sequence, sizeof(sequence), "%s%lu-%lu", r ? "," : ";",
+                         (unsigned long)sequences[i].ranges[r].first, (unsigned long)sequences[i].ranges[r].end);
+                file.print(sequence);
+            }
+            snprintf(sequence, sizeof(sequence), ";%lu", (unsigned long)sequences[i].newest);
+            file.print(sequence);
+        }
+        file.print("\n");
+    }
+    file.close();
+}
+
+bool nodeRegistryBegin(fs::FS &fs) {
+    count = 0;
+    snapshotCount = 0;
+    registryFs = &fs;
+
+    File file = fs.open(NODE_REGISTRY_FILE, FILE_READ);
+    if (file) {
+        char line[256];
+
+        while (file.available() && count < NODE_MAX) {
+            size_t len = file.readBytesUntil('\n', line, sizeof(line) - 1);
+            line[len] = '\0';
+
+            char *separator = strchr(line, ';');
+            if (!separator) continue;
+            *separator = '\0';
+            if (!nodeIdValid(line) || findLocked(line) >= 0) continue;
+
+            int index = addLocked(line);
+            NodeInfo &node = nodes[index];
+
+            // Optional dahinter die angenommenen Bereiche und der jüngste
+            // Zeitstempel; eine ältere Datei hat nur die nächste Nummer, dann
+            // gilt alles darunter als angenommen
+            char *sequence = strchr(separator + 1, ';');
+            if (sequence) {
+                *sequence = '\0';
+                char *pos = sequence + 1;
+                NodeSequences &sequences = node.sequences;
+                while (sequences.count < NODE_SEQUENCE_RANGES) {
+                    char *end;
+                    uint32_t first = strtoul(pos, &end, 10);
+                    uint32_t last = first;
+                    if (*end == '-') last = strtoul(end + 1, &end, 10);
+                    else if (end != pos) first = 0;
+                    if (end == pos || last <= first) break;
+
+                    sequences.ranges[sequences.count++] = { first, last };
+                    pos = end;
+                    if (*pos != ',') break;
+                    pos++;
+                }
+                if (*pos == ';') sequences.newest = strtoul(pos + 1, NULL, 10);
+            }
+            durable[index] = node.sequences;
+
+            // Noch kein anderer Task aktiv, daher ohne registrySeq
+            for (char *name = strtok(separator + 1, ","); name && node.channelCount < NODE_MAX_CHANNELS;
+                 name = strtok(NULL, ",")) {
+                int kind = channelKindFromName(name);
+                if (kind >= 0) node.channels[node.channelCount++] = kind;
+            }
+        }
+        file.close();
+    }
+
+    // Der ESP32 steht immer an Index 0
+    if (count == 0 || strcmp(nodes[NODE_LOCAL].id, NODE_LOCAL_ID) != 0) {
+        if (count > 0) {
+            Serial.println("Node-Liste ohne lokalen Node, wird neu angelegt!");
+            count = 0;
+        }
+        addLocked(NODE_LOCAL_ID);
+        saveRegistry();
+    }
+
+    Serial.printf("Node-Registry: %u Nodes\n", count);
+    return true;
+}
+
+uint8_t nodeCount() {
+    return count;
+}
+
+uint32_t nodeVersion() {
+    return registrySeq.version();
+}
+
+int nodeFind(const char *id) {
+    portENTER_CRITICAL(&registryMux);
+    int index = findLocked(id);
+    portEXIT_CRITICAL(&registryMux);
+    return index;
+}
+
+int nodeRegister(const char *id) {
+    if (!nodeIdValid(id)) return -1;
+
+    bool added = false;
+
+    portENTER_CRITICAL(&registryMux);
+    int index = findLocked(id);
+    if (index < 0) {
+        index = addLocked(id);
+        added = index >= 0;
+        if (added) layoutDirty = true;
+    }
+    portEXIT_CRITICAL(&registryMux);
+
+    if (added) Serial.printf("Neuer Node: %s (%d)\n", id, index);
+    return index;
+}
+
+int nodeChannelSlot(uint8_t node, ChannelKind kind, bool create) {
+    int slot = -1;
+
+    portENTER_CRITICAL(&registryMux);
+    if (node < count) {
+        NodeInfo &info = nodes[node];
+
+        for (int i = 0; i < info.channelCount; i++) {
+            if (info.channels[i] == kind) slot = i;
+        }
+
+        if (slot < 0 && create && info.channelCount < NODE_MAX_CHANNELS) {
+            registrySeq.writeBegin();
+            slot = info.channelCount++;
+            info.channels[slot] = kind;
+            registrySeq.writeEnd();
+            layoutDirty = true;
+        }
+    }
+    portEXIT_CRITICAL(&registryMux);
+
+    return slot;
+}
+
+void nodeUpdate(const SensorRecord &record) {
+    portENTER_CRITICAL(&registryMux);
+    if (record.node < count) {
+        registrySeq.writeBegin();
+        NodeInfo &info = nodes[record.node];
+
+        // Nachgelieferte Messungen zählen, ändern aber nicht die aktuellen Werte
+        if (record.timestamp >= info.lastSeen) {
+            for (int i = 0; i < info.channelCount; i++) {
+                if (record.valid & (1 << i)) info.values[i] = record.values[i];
+            }
+            info.valid |= record.valid;
+            info.lastSeen = record.timestamp;
+        }
+        info.samples++;
+        registrySeq.writeEnd();
+    }
+    portEXIT_CRITICAL(&registryMux);
+}
+
+// Index des Bereichs mit seq, -1 wenn keiner. Nur unter registryMux.
+static int findSequence(const NodeSequences &sequences, uint32_t seq) {
+    for (int i = 0; i < sequences.count; i++) {
+        if (seq >= sequences.ranges[i].first && seq < sequences.ranges[i].end) return i;
+    }
+    return -1;
+}
+
+// seq liegt in einem angenommenen Bereich; hat der Node neu gezählt? Eine
+// Wiederholung trägt ihren alten Zeitstempel und liegt höchstens so weit
+// zurück, wie der Node noch nicht gelöscht hat. Nur unter registryMux.
+static bool sequenceRestarted(const NodeSequences &sequences, uint32_t seq, uint32_t timestamp) {
+    if (timestamp && sequences.newest && timestamp > sequences.newest) return true;
+    return seq + NODE_SEQUENCE_RESTART < sequences.ranges[0].end;
+}
+
+bool nodeSequenceIsNew(uint8_t node, uint32_t seq, uint32_t timestamp) {
+    bool fresh = true;
+
+    portENTER_CRITICAL(&registryMux);
+    if (node < count && findSequence(nodes[node].sequences, seq) >= 0) {
+        fresh = sequenceRestarted(nodes[node].sequences, seq, timestamp);
+    }
+    portEXIT_CRITICAL(&registryMux);
+    return fresh;
+}
+
+// seq in die Bereiche einfügen; false, wenn dafür eine Lücke aufgegeben wurde.
+// Nur unter registryMux.
+static bool insertSequence(NodeSequences &sequences, uint32_t seq) {
+    SequenceRange *ranges = sequences.ranges;
+    int n = sequences.count;
+
+    int i = 0;
+    while (i < n && ranges[i].end < seq) i++;
+
+    if (i < n && seq >= ranges[i].first && seq < ranges[i].end) return true;
+
+    if (i < n && ranges[i].end == seq) {
+        // Direkt hinter Bereich i, stößt vielleicht an den nächsten
+        ranges[i].end++;
+        if (i + 1 < n && ranges[i + 1].first == ranges[i].end) {
+            ranges[i].end = ranges[i + 1].end;
+            memmove(&ranges[i + 1], &ranges[i + 2], (n - i - 2) * sizeof(SequenceRange));
+            sequences.count--;
+        }
+        return true;
+    }
+
+    if (i < n && ranges[i].first == seq + 1) {
+        ranges[i].first = seq;
+        return true;
+    }
+
+    // Neuer Bereich an Stelle i
+    SequenceRange merged[NODE_SEQUENCE_RANGES + 1];
+    memcpy(merged, ranges, i * sizeof(SequenceRange));
+    merged[i] = { seq, seq + 1 };
+    memcpy(&merged[i + 1], &ranges[i], (n - i) * sizeof(SequenceRange));
+    n++;
+
+    // Ist keiner mehr frei, die kleinste Lücke schließen
+    bool kept = n <= NODE_SEQUENCE_RANGES;
+    if (!kept) {
+        int closest = 0;
+        for (int j = 1; j + 1 < n; j++) {
+            if (merged[j + 1].first - merged[j].end < merged[closest + 1].first - merged[closest].end) closest = j;
+        }
+        merged[closest].end = merged[closest + 1].end;
+        memmove(&merged[closest + 1], &merged[closest + 2], (n - closest - 2) * sizeof(SequenceRange));
+        n--;
+    }
+
+    memcpy(ranges, merged, n * sizeof(SequenceRange));
+    sequences.count = n;
+    return kept;
+}
+
+void nodeSequenceCommit(uint8_t node, uint32_t seq, uint32_t timestamp) {
+    bool restarted = false;
+    bool kept = true;
+
+    portENTER_CRITICAL(&registryMux);
+    if (node < count) {
+        NodeSequences &sequences = nodes[node].sequences;
+        registrySeq.writeBegin();
+
+        // Neu gezählt: alte Bereiche und der gesicherte Stand gelten nicht mehr,
+        // sonst hieße next_seq "alles unter der alten Nummer löschen"
+        if (findSequence(sequences, seq) >= 0 && sequenceRestarted(sequences, seq, timestamp)) {
+            memset(&sequences, 0, sizeof(sequences));
+            memset(&durable[node], 0, sizeof(durable[node]));
+            epochs[node]++;
+            sequencesDirty = true;
+            restarted = true;
+        }
+
+        kept = insertSequence(sequences, seq);
+        if (timestamp > sequences.newest) sequences.newest = timestamp;
+
+        registrySeq.writeEnd();
+    }
+    portEXIT_CRITICAL(&registryMux);
+
+    if (restarted) Serial.printf("Node %u zählt neu ab %lu\n", node, (unsigned long)seq);
+    if (!kept) Serial.printf("Node %u: zu viele Lücken, die kleinste wird aufgegeben\n", node);
+}
+
+void nodeSequenceSnapshot() {
+    portENTER_CRITICAL(&registryMux);
+    snapshotCount = count;
+    for (int i = 0; i < snapshotCount; i++) {
+        snapshot[i] = nodes[i].sequences;
+        snapshotEpochs[i] = epochs[i];
+    }
+    portEXIT_CRITICAL(&registryMux);
+}
+
+void nodeSequenceDurable() {
+    portENTER_CRITICAL(&registryMux);
+    for (int i = 0; i < snapshotCount; i++) {
+        if (snapshotEpochs[i] != epochs[i]) continue;
+        durable[i] = snapshot[i];
+        sequencesDirty = true;
+    }
+    snapshotCount = 0;
+    portEXIT_CRITICAL(&registryMux);
+}
+
+uint32_t nodeSequenceNext(uint8_t node) {
+    portENTER_CRITICAL(&registryMux);
+    uint32_t next = node < count && durable[node].count ? durable[node].ranges[0].end : 0;
+    portEXIT_CRITICAL(&registryMux);
+    return next;
+}
+
+void nodeRegistryFlush(bool sequences) {
+    if (layoutDirty || (sequences && sequencesDirty)) saveRegistry();
+}
+
+bool nodeGet(uint8_t node, NodeInfo &info) {
+    bool ok;
+    uint32_t start;
+
+    do {
+        start = registrySeq.readBegin();
+        ok = node < count;
+        if (ok) info = nodes[node];
+    } while (registrySeq.readRetry(start));
+
+    return ok;
+}
+
+uint32_t nodeSnapshot(NodeInfo *out, uint8_t &total) {
+    uint32_t start;
+
+    do {
+        start = registrySeq.readBegin();
+        total = count;
+        memcpy(out, nodes, total * sizeof(NodeInfo));
+    } while (registrySeq.readRetry(start));
+
+    return start >> 1;
+}
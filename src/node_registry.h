@@ -0,0 +1,142 @@
+// node_registry.h - Alle Sensor-Nodes mit ihren Kanälen und letzten Werten
+//
+// Ein Node ist über seine ID ("esp32", "pico", "keller", ...) bekannt und
+// bekommt beim ersten Kontakt einen festen Index, unter dem er im Log steht.
+// Seine Kanäle (bis zu SENSOR_LOG_VALUES) werden in der Reihenfolge
+// angelegt, in der sie zum ersten Mal gemeldet werden, und nie umsortiert -
+// Slot i eines Nodes bedeutet im Log also immer denselben Kanal.
+//
+// Die Zuordnung wird in /nodes.txt gesichert
+// ("id;kanal,kanal,...;von-bis,von-bis,...;zeit"): die Bereiche laufender
+// Nummern des Nodes (bis ausschließlich), die sicher im Log stehen, und der
+// jüngste Zeitstempel einer Messung mit Nummer (siehe nodeSequenceIsNew()).
+// Änderungen aus dem ingest-Task, AsyncTCP und UDP laufen über einen Spinlock
+// und markieren die Datei nur als geändert - schreiben tut sie allein der
+// storage-Task mit nodeRegistryFlush(), nie zwei Tasks zugleich. Leser
+// (/sensors, /events, /sd-data) kopieren über einen Seqlock und blockieren
+// dabei keinen Schreiber.
+#ifndef NODE_REGISTRY_H
+#define NODE_REGISTRY_H
+
+#include <Arduino.h>
+#include "FS.h"
+#include "sensor_log.h"
+
+#define NODE_REGISTRY_FILE  "/nodes.txt"
+#define NODE_MAX            32
+#define NODE_ID_LEN         16          // inkl. '\0'
+#define NODE_MAX_CHANNELS   SENSOR_LOG_VALUES
+#define NODE_SEQUENCE_RANGES 4          // getrennte Bereiche angenommener Nummern je Node
+#define NODE_SEQUENCE_RESTART 4096      // so weit unter next_seq zurück: Zähler neu begonnen
+
+// Der ESP32 selbst ist immer Node 0
+#define NODE_LOCAL          0
+#define NODE_LOCAL_ID       "esp32"
+
+enum ChannelKind {
+    KIND_TEMPERATURE = 0,
+    KIND_HUMIDITY,
+    KIND_PRESSURE,
+    KIND_CO2,
+    KIND_LIGHT,
+    KIND_BATTERY,
+    CHANNEL_KINDS
+};
+
+// Angenommene laufende Nummern first .. end-1
+struct SequenceRange {
+    uint32_t first;
+    uint32_t end;
+};
+
+struct NodeSequences {
+    SequenceRange ranges[NODE_SEQUENCE_RANGES];     // aufsteigend, mit Lücke dazwischen
+    uint8_t count;
+    uint32_t newest;                        // jüngster eigener Zeitstempel einer Messung mit seq, 0 = unbekannt
+};
+
+struct NodeInfo {
+    char id[NODE_ID_LEN];
+    uint8_t channelCount;
+    uint8_t channels[NODE_MAX_CHANNELS];    // ChannelKind je Slot
+    uint8_t valid;                          // Bit i = values[i] schon einmal gemeldet
+    float values[NODE_MAX_CHANNELS];        // letzte Werte
+    uint32_t lastSeen;                      // Unix-Zeit der letzten Messung, 0 = noch nie
+    uint32_t samples;                       // Messungen seit dem Start
+    NodeSequences sequences;                // angenommen, aber vielleicht noch nicht auf der Karte
+};
+
+// Lädt /nodes.txt und legt den lokalen Node an
+bool nodeRegistryBegin(fs::FS &fs);
+
+uint8_t nodeCount();
+
+// Index zur ID, -1 wenn unbekannt
+int nodeFind(const char *id);
+
+// Index zur ID, legt den Node bei Bedarf an. -1 bei ungültiger ID oder vollem Register.
+int nodeRegister(const char *id);
+
+// Slot des Kanals beim Node; create legt ihn bei Bedarf an. -1 wenn nicht vorhanden/voll.
+int nodeChannelSlot(uint8_t node, ChannelKind kind, bool create);
+
+// Neue Messung übernehmen (gültige Slots laut record.valid). Die letzten
+// Werte ersetzt nur eine Messung, die nicht älter ist als lastSeen.
+void nodeUpdate(const SensorRecord &record);
+
+// Ist die Messung mit laufender Nummer seq neu? Ja, solange seq in keinem
+// der angenommenen Bereiche liegt - eine Lücke, die der Node später füllt
+// (Puffer nach einem Ausfall, während er schon wieder live sendet), bleibt
+// so offen, egal wie weit sie zurückliegt. Liegt seq in einem Bereich, ist
+// sie eine Wiederholung - außer der Node hat seinen Zähler neu begonnen:
+// ihr eigener timestamp ist jünger als alles, was er mit Nummer geschickt
+// hat, oder sie liegt mehr als NODE_SEQUENCE_RESTART unter nodeSequenceNext().
+// timestamp 0 = unbekannt. O(NODE_SEQUENCE_RANGES).
+bool nodeSequenceIsNew(uint8_t node, uint32_t seq, uint32_t timestamp);
+
+// seq ist angenommen; Argumente wie bei nodeSequenceIsNew(). Ein neu
+// begonnener Zähler verwirft die alten Bereiche. Gibt es mehr als
+// NODE_SEQUENCE_RANGES Bereiche, wird die kleinste Lücke aufgegeben - eine
+// Messung daraus gilt dann als Wiederholung.
+void nodeSequenceCommit(uint8_t node, uint32_t seq, uint32_t timestamp);
+
+// Eine angenommene Messung steht erst nach dem nächsten Schreiben des Logs
+// sicher auf der Karte. Quittiert (nodeSequenceNext()) und gesichert wird
+// deshalb ein Stand, den der storage-Task freigibt: nodeSequenceSnapshot()
+// merkt sich die angenommenen Bereiche, sobald alles davor auf dem Weg ins
+// Log ist (siehe ingestSequenceSnapshot()); nodeSequenceDurable() übernimmt
+// ihn, wenn alles davor geschrieben ist. Zählt ein Node dazwischen neu,
+// bleibt sein Stand bis zum nächsten Mal leer. Nach einem Neustart gilt nur
+// der gesicherte Stand als angenommen - was verloren ging, schickt der Node
+// noch einmal.
+void nodeSequenceSnapshot();
+void nodeSequenceDurable();
+
+// Nächste Nummer, bis zu der lückenlos alles sicher im Log steht (Ende des
+// ersten gesicherten Bereichs), 0 = keine bekannt
+uint32_t nodeSequenceNext(uint8_t node);
+
+// Neue Nodes und Kanäle nach /nodes.txt, mit sequences auch geänderte
+// laufende Nummern. Nur aus dem storage-Task: vor jedem Log-Eintrag ohne
+// sequences (der Node steht in der Datei, bevor das Log ihn nennt), zusammen
+// mit dem Log mit, damit nach einem Neustart keine Wiederholung durchrutscht.
+void nodeRegistryFlush(bool sequences = true);
+
+// Kopie eines Eintrags, false bei ungültigem Index
+bool nodeGet(uint8_t node, NodeInfo &info);
+
+// Konsistente Kopie aller Nodes nach out (Platz für NODE_MAX Einträge).
+// Gibt die Version dieses Stands zurück, sie steigt mit jeder Änderung.
+uint32_t nodeSnapshot(NodeInfo *out, uint8_t &total);
+
+// Version des aktuellen Stands, ohne zu kopieren
+uint32_t nodeVersion();
+
+// "temperature" <-> KIND_TEMPERATURE
+const char *channelKindName(uint8_t kind);
+int channelKindFromName(const char *name);
+
+// Erlaubt sind [a-z0-9_-], 1 bis NODE_ID_LEN-1 Zeichen
+bool nodeIdValid(const char *id);
+
+#endif
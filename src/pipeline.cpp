@@ -0,0 +1,340 @@
+#include "pipeline.h"
+#include "ingest.h"
+#include "sensor_log.h"
+#include "sample_ring.h"
+#include "rollup.h"
+#include "channel_stats.h"
+#include "live_events.h"
+#include "alerts.h"
+#include "weather.h"
+
+#define ACQUISITION_STACK   4096
+#define INGEST_STACK        4096
+#define STORAGE_STACK       6144
+
+#define ACQUISITION_POLL_MS AHT20_RETRY_MS
+
+static void (*readingHandler)(const LocalReading &reading) = nullptr;
+
+static QueueHandle_t storageQueue = NULL;
+static uint32_t storageHighWater = 0;
+static uint32_t storageDropped = 0;
+
+// Umsortier-Fenster, nach Zeit sortiert; nur der storage-Task.
+// arrival zählt die Ankünfte mit (für den Sicherungspunkt).
+struct HeldRecord {
+    SensorRecord record;
+    uint32_t arrival;
+};
+
+static HeldRecord reorder[PIPELINE_REORDER_RECORDS];
+static size_t reorderCount = 0;
+static uint32_t arrivals = 0;
+
+// Sicherungspunkt der laufenden Nummern (nodeSequenceDurable()): storage
+// fordert ihn an, ingest merkt sich die Nummern und schickt eine Marke
+// hinterher. Hat die Marke alles vor ihr aus dem Fenster gedrängt und ist
+// danach alles geschrieben, gibt storage den Stand frei.
+enum BarrierState {
+    BARRIER_IDLE,
+    BARRIER_REQUESTED,          // ingest soll die Marke schicken
+    BARRIER_RELEASING,          // Marke da, davor Angekommenes noch im Fenster
+    BARRIER_RELEASED            // alles davor im Log, wartet aufs Schreiben
+};
+
+static_assert(PIPELINE_BARRIER_NODE >= NODE_MAX, "Die Marke darf kein Node sein");
+
+static volatile bool barrierRequested = false;
+static BarrierState barrierState = BARRIER_IDLE;    // nur der storage-Task
+static uint32_t barrierArrival = 0;
+
+static TaskHandle_t acquisitionHandle = NULL;
+static TaskHandle_t ingestHandle = NULL;
+static TaskHandle_t storageHandle = NULL;
+
+static void acquisitionTask(void *parameter) {
+    for (;;) {
+        LocalReading reading;
+        if (acquisitionPoll(reading) && readingHandler) readingHandler(reading);
+
+        vTaskDelay(pdMS_TO_TICKS(ACQUISITION_POLL_MS));
+    }
+}
+
+static void ingestTask(void *parameter) {
+    static uint32_t liveNewest[NODE_MAX];
+    uint32_t lastWeatherFetch = 0;
+    int lastWeatherError = 0;
+
+    for (;;) {
+        SensorRecord record;
+
+        // Höchstens eine Sekunde warten, dann auch ohne Messung nach dem Wetter sehen
+        if (ingestNextPending(record, 1000)) {
+            // Nachgelieferte (ältere) Messungen gehören nicht in die Live-Ansicht
+            // und lösen keine Alarme aus
+            if (record.node < NODE_MAX && record.timestamp >= liveNewest[record.node]) {
+                liveNewest[record.node] = record.timestamp;
+                liveEventsSample(record);
+                alertsSample(record);
+            }
+
+            if (xQueueSend(storageQueue, &record, pdMS_TO_TICKS(PIPELINE_STORAGE_WAIT_MS)) != pdTRUE) {
+                storageDropped++;
+                Serial.println("Storage-Queue voll, Messung wird nicht geloggt!");
+            } else {
+                uint32_t depth = uxQueueMessagesWaiting(storageQueue);
+                if (depth > storageHighWater) storageHighWater = depth;
+            }
+        }
+
+        // Sicherungspunkt: erst wenn alles Angenommene weitergegeben ist,
+        // dahinter die Marke - storage sieht sie nach allem, was dazugehört
+        if (barrierRequested && uxQueueMessagesWaiting(storageQueue) < PIPELINE_STORAGE_QUEUE
+            && ingestSequenceSnapshot()) {
+            SensorRecord marker;
+            memset(&marker, 0, sizeof(marker));
+            marker.node = PIPELINE_BARRIER_NODE;
+            xQueueSend(storageQueue, &marker, 0);
+            barrierRequested = false;
+        }
+
+        // Nodes, die sich zu lange nicht gemeldet haben
+        alertsTick((uint32_t)time(nullptr));
+
+        // Neuer Wetterstand aus dem Wetter-Task
+        WeatherState weather;
+        weatherGet(weather);
+        if (weather.fetchedAt != lastWeatherFetch || weather.lastError != lastWeatherError) {
+            lastWeatherFetch = weather.fetchedAt;
+            lastWeatherError = weather.lastError;
+            liveEventsWeather(weather);
+        }
+    }
+}
+
+// Hängt eine Messung aus dem Umsortier-Fenster ans Log
+static void appendRecord(const SensorRecord &record) {
+    if (!sensorLogAppend(record)) {
+        Serial.println("Fehler beim Schreiben ins Log!");
+        return;
+    }
+
+    // Für /sd-data im RAM halten, Stunden-/Tageswerte und Statistik mitführen
+    sampleRingPush(sensorLogCount() - 1, record);
+    rollupAdd(record);
+    channelStatsAdd(record);
+}
+
+// Hat der Sicherungspunkt alles vor der Marke aus dem Fenster gedrängt?
+static void checkBarrier() {
+    if (barrierState != BARRIER_RELEASING) return;
+
+    for (size_t i = 0; i < reorderCount; i++) {
+        if (reorder[i].arrival < barrierArrival) return;
+    }
+    barrierState = BARRIER_RELEASED;
+}
+
+// Gibt alle Messungen frei, die PIPELINE_REORDER_SECONDS vor now bzw. vor
+// der jüngsten im Fenster liegen
+static void releaseReordered(uint32_t now) {
+    if (reorderCount == 0) return;
+
+    uint32_t newest = reorder[reorderCount - 1].record.timestamp;
+    if (now < newest) now = newest;
+
+    size_t released = 0;
+    while (released < reorderCount
+           && reorder[released].record.timestamp + PIPELINE_REORDER_SECONDS <= now) {
+        appendRecord(reorder[released++].record);
+    }
+
+    memmove(reorder, reorder + released, (reorderCount - released) * sizeof(HeldRecord));
+    reorderCount -= released;
+    checkBarrier();
+}
+
+static void logRecord(const SensorRecord &record) {
+    // Ohne NTP-Zeit kein Eintrag, sonst landen Messungen im Jahr 1970
+    if (record.timestamp < SENSOR_LOG_MIN_VALID_TIME) {
+        Serial.println("Zeit noch nicht gesetzt, Messung wird nicht geloggt.");
+        return;
+    }
+
+    // Neuer Node oder Kanal: erst /nodes.txt, dann das Log
+    nodeRegistryFlush(false);
+
+    // Älter als das, was das Fenster schon freigegeben hat: wirklich
+    // nachgeliefert, wird später einsortiert und erst dann in die Statistik
+    // eingerechnet (mergeBackfill)
+    if (record.timestamp < sensorLogNewest()) {
+        if (!sensorLogBackfill(record)) {
+            Serial.println("Kein Platz für Nachlieferungen, Messung wird nicht geloggt!");
+        }
+        return;
+    }
+
+    // Fenster voll: die älteste geht vorzeitig ins Log
+    if (reorderCount == PIPELINE_REORDER_RECORDS) {
+        appendRecord(reorder[0].record);
+        memmove(reorder, reorder + 1, --reorderCount * sizeof(HeldRecord));
+    }
+
+    // Von hinten einsortieren, meist bleibt die Messung gleich am Ende;
+    // gleiche Zeitstempel behalten ihre Ankunftsreihenfolge
+    size_t pos = reorderCount;
+    while (pos > 0 && reorder[pos - 1].record.timestamp > record.timestamp) {
+        reorder[pos] = reorder[pos - 1];
+        pos--;
+    }
+    reorder[pos].record = record;
+    reorder[pos].arrival = arrivals++;
+    reorderCount++;
+
+    releaseReordered((uint32_t)time(nullptr));
+}
+
+// Jüngster Zeitstempel, den das laufende sensorLogMerge() eingefügt hat
+static uint32_t mergedNewest = 0;
+
+static void onMerged(const SensorRecord &record) {
+    channelStatsAdd(record);
+    rollupInvalidate(record);
+    if (record.timestamp > mergedNewest) mergedNewest = record.timestamp;
+}
+
+// Nachlieferungen einsortieren, ein Tag pro Aufruf; in die Statistik kommt
+// nur, was nicht schon im Log stand. Im Messwert-Puffer wird danach nur der
+// verschobene Teil nachgeladen. Ist alles einsortiert, werden die betroffenen
+// Rollup-Fenster neu berechnet, ein Tag und Node pro Aufruf. false, wenn
+// nichts zu tun war.
+static bool mergeBackfill() {
+    uint32_t from;
+    mergedNewest = 0;
+
+    uint32_t inserted = sensorLogMerge(from, onMerged);
+    if (inserted > 0) {
+        sampleRingMerged(from, mergedNewest, inserted);
+        return true;
+    }
+
+    return rollupRebuildStale();
+}
+
+// Partitionen jenseits von SENSOR_LOG_RETENTION_DAYS löschen, höchstens einmal pro Stunde
+static void pruneLog() {
+    static unsigned long lastPrune = 0;
+    if (SENSOR_LOG_RETENTION_DAYS == 0 || (lastPrune && millis() - lastPrune < 3600000UL)) return;
+
+    time_t now = time(nullptr);
+    if (now < (time_t)SENSOR_LOG_MIN_VALID_TIME) return;
+
+    lastPrune = millis();
+    sensorLogPrune((uint32_t)now - SENSOR_LOG_RETENTION_DAYS * SENSOR_LOG_PARTITION_SECONDS);
+}
+
+static void storageTask(void *parameter) {
+    unsigned long lastFlush = millis();
+
+    for (;;) {
+        SensorRecord record;
+        if (xQueueReceive(storageQueue, &record, pdMS_TO_TICKS(1000)) == pdTRUE) {
+            if (record.node == PIPELINE_BARRIER_NODE) {
+                barrierArrival = arrivals;
+                barrierState = BARRIER_RELEASING;
+                checkBarrier();
+            } else {
+                logRecord(record);
+            }
+        } else {
+            // Leerlauf: Fenster nach der Uhr leeren, dann Nachlieferungen
+            // einsortieren, sonst einen abgeschlossenen Tag komprimieren
+            releaseReordered((uint32_t)time(nullptr));
+            if (!mergeBackfill()) sensorLogCompact();
+        }
+
+        // Gepufferte Log-Sätze, offene Rollup-Fenster, Statistik und laufende Nummern der Nodes sichern
+        if (millis() - lastFlush > SENSOR_LOG_FLUSH_INTERVAL) {
+            lastFlush = millis();
+            sensorLogFlush();
+            rollupFlush();
+            channelStatsFlush();
+
+            // Alles bis zum Sicherungspunkt steht auf der Karte: erst jetzt
+            // dürfen Nodes es löschen (next_seq), dann den nächsten anfordern
+            if (barrierState == BARRIER_RELEASED && sensorLogWritten()) {
+                nodeSequenceDurable();
+                barrierState = BARRIER_IDLE;
+            }
+            nodeRegistryFlush();
+            if (barrierState == BARRIER_IDLE) {
+                barrierState = BARRIER_REQUESTED;
+                barrierRequested = true;
+            }
+
+            pruneLog();
+        }
+    }
+}
+
+bool pipelineBegin(void (*onReading)(const LocalReading &reading)) {
+    readingHandler = onReading;
+
+    storageQueue = xQueueCreate(PIPELINE_STORAGE_QUEUE, sizeof(SensorRecord));
+    if (!storageQueue) {
+        Serial.println("Storage-Queue konnte nicht angelegt werden!");
+        return false;
+    }
+
+    bool ok = xTaskCreatePinnedToCore(storageTask, "storage", STORAGE_STACK, NULL, 2,
+                                      &storageHandle, PIPELINE_CORE_SENSORS) == pdPASS
+           && xTaskCreatePinnedToCore(ingestTask, "ingest", INGEST_STACK, NULL, 3,
+                                      &ingestHandle, PIPELINE_CORE_SENSORS) == pdPASS
+           && xTaskCreatePinnedToCore(acquisitionTask, "acquisition", ACQUISITION_STACK, NULL, 4,
+                                      &acquisitionHandle, PIPELINE_CORE_SENSORS) == pdPASS;
+
+    weatherBegin(PIPELINE_CORE_NETWORK);
+
+    if (!ok) Serial.println("Pipeline-Tasks konnten nicht gestartet werden!");
+    return ok;
+}
+
+static void addTask(PipelineStats &stats, const char *name, TaskHandle_t handle, int core, uint32_t stackSize) {
+    if (!handle || stats.taskCount >= PIPELINE_MAX_TASKS) return;
+
+    PipelineTaskStats &task = stats.tasks[stats.taskCount++];
+    task.name = name;
+    task.core = core;
+    task.priority = uxTaskPriorityGet(handle);
+    task.stackSize = stackSize;
+    // Auf dem ESP32 zählt der Stack in Byte
+    task.stackFree = uxTaskGetStackHighWaterMark(handle);
+}
+
+void pipelineStats(PipelineStats &stats) {
+    stats.taskCount = 0;
+    addTask(stats, "acquisition", acquisitionHandle, PIPELINE_CORE_SENSORS, ACQUISITION_STACK);
+    addTask(stats, "ingest", ingestHandle, PIPELINE_CORE_SENSORS, INGEST_STACK);
+    addTask(stats, "storage", storageHandle, PIPELINE_CORE_SENSORS, STORAGE_STACK);
+    addTask(stats, "weather", weatherTaskHandle(), PIPELINE_CORE_NETWORK, WEATHER_TASK_STACK);
+#ifdef CONFIG_ASYNC_TCP_RUNNING_CORE
+    addTask(stats, "async_tcp", xTaskGetHandle("async_tcp"), CONFIG_ASYNC_TCP_RUNNING_CORE, 0);
+#else
+    addTask(stats, "async_tcp", xTaskGetHandle("async_tcp"), -1, 0);
+#endif
+
+    stats.queueCount = 0;
+
+    PipelineQueueStats &ingest = stats.queues[stats.queueCount++];
+    ingest.name = "ingest";
+    ingest.capacity = INGEST_QUEUE_LENGTH;
+    ingestQueueStats(ingest.depth, ingest.highWater, ingest.dropped);
+
+    PipelineQueueStats &storage = stats.queues[stats.queueCount++];
+    storage.name = "storage";
+    storage.capacity = PIPELINE_STORAGE_QUEUE;
+    storage.depth = storageQueue ? uxQueueMessagesWaiting(storageQueue) : 0;
+    storage.highWater = storageHighWater;
+    storage.dropped = storageDropped;
+}
@@ -0,0 +1,92 @@
+// pipeline.h - Feste Task-Aufteilung für Messen, Verarbeiten, Speichern und Netz
+//
+//   acquisition (Kern 1, Prio 4)  lokale Sensoren abfragen -> ingestSample()
+//         |  Ingest-Queue, 64 Sätze; voll = Messung abweisen (Nodes senden neu)
+//   ingest      (Kern 1, Prio 3)  Delta an Dashboards (/events), Alarm-Regeln
+//                                 (alerts.h), weiter an storage
+//         |  Storage-Queue, 128 Sätze; voll = bis 1 s warten (Gegendruck bis
+//         |  zur Ingest-Queue), danach verwerfen und zählen
+//   storage     (Kern 1, Prio 2)  Umsortier-Fenster, Binär-Log, Messwert-Puffer,
+//                                 Rollups, Statistik (channel_stats.h); einziger
+//                                 Task, der ins Log schreibt. Im Leerlauf:
+//                                 Nachlieferungen einsortieren, Tage komprimieren
+//   weather     (Kern 0, Prio 1)  OpenWeatherMap-Abruf (weather.h)
+//   async_tcp   (Kern 0)          HTTP, gehört dem Webserver
+//
+// Kern 0 gehört dem Netz (WiFi, LwIP, AsyncTCP), Kern 1 den Messwerten. Eine
+// langsame SD-Karte bremst so weder die Sensor-Zeitpunkte (höhere Priorität)
+// noch HTTP-Antworten (anderer Kern).
+//
+// Nodes senden unabhängig voneinander, ihre Messungen kommen also nicht
+// streng nach Zeit an. Der storage-Task hält jede Messung deshalb
+// PIPELINE_REORDER_SECONDS lang in einem kleinen, sortierten Fenster im RAM
+// und hängt sie erst dann ans Log. Was danach noch älter als das Ende des
+// Logs ankommt, ist wirklich nachgeliefert und wird einsortiert
+// (sensorLogBackfill(), neue Revision); ein paar Sekunden Versatz zwischen
+// zwei Nodes kosten so keine Umsortierung. Im Log und unter /sd-data
+// erscheint eine Messung dadurch um dieses Fenster später, /events und
+// /sensors sehen sie sofort; bei einem Absturz gehen zu den noch nicht
+// gesicherten Log-Sätzen auch die Messungen im Fenster verloren.
+//
+// Nodes löschen ihren Puffer erst, wenn ihre Messungen sicher auf der Karte
+// stehen (next_seq, siehe ingest.h). Dazu fordert storage bei jedem
+// Schreiben (SENSOR_LOG_FLUSH_INTERVAL) einen Sicherungspunkt an: ingest
+// merkt sich die angenommenen Nummern, sobald seine Queue leer ist, und
+// schickt eine Marke durch die Storage-Queue. Ist alles, was vor ihr ankam,
+// aus dem Fenster und beim nächsten Schreiben auf der Karte, gilt der Stand
+// als gesichert (nodeSequenceDurable()) - next_seq folgt der Annahme also um
+// ein bis zwei Intervalle.
+//
+// Füllstände und Stack-Reserven aller Tasks liefert pipelineStats(), zu
+// sehen unter /system.
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <Arduino.h>
+#include "sensor_acquisition.h"
+
+#define PIPELINE_CORE_NETWORK       0
+#define PIPELINE_CORE_SENSORS       1
+
+#define PIPELINE_STORAGE_QUEUE      128
+#define PIPELINE_STORAGE_WAIT_MS    1000
+
+#define PIPELINE_REORDER_RECORDS    64          // Umsortier-Fenster, 2 KB
+#define PIPELINE_REORDER_SECONDS    60          // so lange wartet eine Messung darin
+
+#define PIPELINE_BARRIER_NODE       0xFF        // Marke des Sicherungspunkts in der Storage-Queue
+
+#define PIPELINE_MAX_TASKS          6
+#define PIPELINE_MAX_QUEUES         2
+
+struct PipelineTaskStats {
+    const char *name;
+    int core;                   // -1 = nicht festgelegt
+    uint32_t priority;
+    uint32_t stackSize;         // Byte, 0 = unbekannt (fremder Task)
+    uint32_t stackFree;         // kleinste Reserve seit dem Start, Byte
+};
+
+struct PipelineQueueStats {
+    const char *name;
+    uint32_t depth;
+    uint32_t capacity;
+    uint32_t highWater;
+    uint32_t dropped;
+};
+
+struct PipelineStats {
+    PipelineTaskStats tasks[PIPELINE_MAX_TASKS];
+    size_t taskCount;
+    PipelineQueueStats queues[PIPELINE_MAX_QUEUES];
+    size_t queueCount;
+};
+
+// Startet alle Tasks. onReading rechnet eine lokale Messung um (Kalibrierung)
+// und gibt sie an ingestSample() weiter; läuft im acquisition-Task.
+// Muss nach setupSD() und ingestBegin() laufen.
+bool pipelineBegin(void (*onReading)(const LocalReading &reading));
+
+void pipelineStats(PipelineStats &stats);
+
+#endif
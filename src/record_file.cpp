@@ -0,0 +1,165 @@
+#include "record_file.h"
+#include "metrics.h"
+
+RecordFile::RecordFile(const char *path, uint32_t magic, uint16_t version, uint16_t recordSize, uint16_t channels)
+    : magic(magic), version(version), recordSize(recordSize), channels(channels),
+      fs(nullptr), recordCount(0), headerReserved(0) {
+    setPath(path);
+}
+
+void RecordFile::setPath(const char *path) {
+    close();
+    fs = nullptr;
+    recordCount = 0;
+    strncpy(this->path, path, sizeof(this->path) - 1);
+    this->path[sizeof(this->path) - 1] = '\0';
+}
+
+bool RecordFile::create(fs::FS &fs, const char *path, uint32_t magic, uint16_t version,
+                        uint16_t recordSize, uint16_t channels, uint32_t reserved) {
+    File file = fs.open(path, FILE_WRITE);
+    if (!file) return false;
+
+    RecordFileHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = magic;
+    header.version = version;
+    header.headerSize = sizeof(RecordFileHeader);
+    header.recordSize = recordSize;
+    header.channels = channels;
+    header.reserved = reserved;
+
+    bool ok = file.write((const uint8_t *)&header, sizeof(header)) == sizeof(header);
+    file.close();
+    return ok;
+}
+
+void RecordFile::close() {
+    if (writer) writer.close();
+}
+
+bool RecordFile::begin(fs::FS &fs) {
+    close();
+    this->fs = nullptr;
+    recordCount = 0;
+
+    if (!fs.exists(path)) {
+        if (!create(fs, path, magic, version, recordSize, channels)) {
+            Serial.printf("Fehler beim Anlegen von %s!\n", path);
+            return false;
+        }
+        Serial.printf("%s angelegt.\n", path);
+    }
+
+    File file = fs.open(path, FILE_READ);
+    if (!file) {
+        Serial.printf("%s nicht lesbar!\n", path);
+        return false;
+    }
+
+    RecordFileHeader header;
+    size_t len = file.read((uint8_t *)&header, sizeof(header));
+    size_t fileSize = file.size();
+    file.close();
+
+    if (len != sizeof(header)
+        || header.magic != magic
+        || header.version != version
+        || header.headerSize != sizeof(RecordFileHeader)
+        || header.recordSize != recordSize
+        || header.channels != channels) {
+        Serial.printf("%s hat ungültigen Header!\n", path);
+        return false;
+    }
+
+    recordCount = (fileSize - sizeof(RecordFileHeader)) / recordSize;
+    headerReserved = header.reserved;
+    if ((fileSize - sizeof(RecordFileHeader)) % recordSize != 0) {
+        Serial.printf("Unvollständiger Datensatz am Ende von %s wird überschrieben.\n", path);
+    }
+
+    this->fs = &fs;
+    return true;
+}
+
+uint32_t RecordFile::offset(uint16_t recordSize, uint32_t index) {
+    return sizeof(RecordFileHeader) + index * recordSize;
+}
+
+bool RecordFile::write(uint32_t index, const void *records, size_t count) {
+    if (!fs || index > recordCount) return false;
+
+    MetricsScope scope(METRIC_SD_WRITE);
+
+    // "r+" statt FILE_APPEND, damit an der letzten vollständigen Satzgrenze
+    // geschrieben wird und ein abgeschnittener Satz nichts verschiebt
+    if (!writer) writer = fs->open(path, "r+");
+    if (!writer) return false;
+
+    size_t len = count * recordSize;
+    bool ok = writer.seek(offset(recordSize, index))
+           && writer.write((const uint8_t *)records, len) == len;
+    writer.flush();
+
+    // Beim nächsten Mal neu öffnen, falls das Handle kaputt ist (Karte gezogen)
+    if (!ok) writer.close();
+
+    if (ok && index + count > recordCount) recordCount = index + count;
+    return ok;
+}
+
+size_t RecordFile::read(uint32_t first, void *records, size_t maxRecords) const {
+    if (!fs) return 0;
+    return read(*fs, path, recordSize, recordCount, first, records, maxRecords);
+}
+
+uint32_t RecordFile::lowerBound(uint32_t t) const {
+    if (!fs) return 0;
+    return lowerBound(*fs, path, recordSize, recordCount, t);
+}
+
+size_t RecordFile::read(fs::FS &fs, const char *path, uint16_t recordSize, uint32_t count,
+                        uint32_t first, void *records, size_t maxRecords) {
+    if (first >= count) return 0;
+
+    if (maxRecords > count - first) maxRecords = count - first;
+
+    MetricsScope scope(METRIC_SD_READ);
+    File file = fs.open(path, FILE_READ);
+    if (!file) return 0;
+
+    size_t read = 0;
+    if (file.seek(offset(recordSize, first))) {
+        size_t len = file.read((uint8_t *)records, maxRecords * recordSize);
+        read = len / recordSize;
+    }
+    file.close();
+    return read;
+}
+
+uint32_t RecordFile::lowerBound(fs::FS &fs, const char *path, uint16_t recordSize, uint32_t count, uint32_t t) {
+    if (count == 0) return 0;
+
+    MetricsScope scope(METRIC_SD_READ);
+    File file = fs.open(path, FILE_READ);
+    if (!file) return 0;
+
+    uint32_t low = 0;
+    uint32_t high = count;
+    uint32_t timestamp;
+
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+
+        if (!file.seek(offset(recordSize, mid))
+            || file.read((uint8_t *)&timestamp, sizeof(timestamp)) != sizeof(timestamp)) {
+            break;
+        }
+
+        if (timestamp < t) low = mid + 1;
+        else high = mid;
+    }
+
+    file.close();
+    return low;
+}
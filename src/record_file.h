@@ -0,0 +1,87 @@
+// record_file.h - Datei aus Header + Datensätzen fester Größe auf der SD-Karte
+//
+// Layout (little endian, wie der ESP32):
+//   RecordFileHeader  16 Byte, einmal am Dateianfang
+//   Datensätze        recordSize Byte, die ersten 4 Byte sind die Unix-Zeit
+//
+// Datensatz i liegt bei headerSize + i * recordSize, Zugriff per Index ist O(1).
+// Wird von den Log-Partitionen, ihrem Manifest und den Rollup-Stufen verwendet.
+//
+// Zum Schreiben bleibt die Datei offen; nach jedem write() wird geflusht,
+// damit Dateigröße und Daten auf der Karte stehen und Leser (eigene Handles,
+// auch aus anderen Tasks) sie sehen.
+#ifndef RECORD_FILE_H
+#define RECORD_FILE_H
+
+#include <Arduino.h>
+#include "FS.h"
+
+#define RECORD_FILE_PATH_MAX 48
+
+struct RecordFileHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t headerSize;
+    uint16_t recordSize;
+    uint16_t channels;
+    uint32_t reserved;          // frei für den Besitzer der Datei (Log-Manifest: Revision)
+};
+
+static_assert(sizeof(RecordFileHeader) == 16, "RecordFileHeader muss 16 Byte haben");
+
+class RecordFile {
+public:
+    RecordFile(const char *path, uint32_t magic, uint16_t version, uint16_t recordSize, uint16_t channels);
+
+    // Legt die Datei bei Bedarf an und prüft den Header
+    bool begin(fs::FS &fs);
+
+    // Auf eine andere Datei desselben Formats umstellen; danach begin()
+    void setPath(const char *path);
+    const char *filePath() const { return path; }
+
+    // Schreib-Handle schließen, z.B. bevor die Datei gelöscht wird
+    void close();
+    bool ready() const { return fs != nullptr; }
+
+    // Anzahl vollständiger Datensätze; ein abgeschnittener Satz am Ende zählt nicht
+    uint32_t count() const { return recordCount; }
+
+    // reserved aus dem Header, gelesen bei begin()
+    uint32_t reserved() const { return headerReserved; }
+
+    // Schreibt count Sätze ab index (index <= count(), index == count() hängt an)
+    bool write(uint32_t index, const void *records, size_t count = 1);
+    bool append(const void *records, size_t count = 1) { return write(recordCount, records, count); }
+
+    size_t read(uint32_t first, void *records, size_t maxRecords) const;
+
+    // Erster Index mit Zeitstempel >= t (binäre Suche)
+    uint32_t lowerBound(uint32_t t) const;
+
+    // Nur den Header schreiben (vorhandene Datei wird geleert)
+    static bool create(fs::FS &fs, const char *path, uint32_t magic, uint16_t version,
+                       uint16_t recordSize, uint16_t channels, uint32_t reserved = 0);
+
+    // Lesen ohne geöffnete RecordFile, wenn die Anzahl Sätze schon bekannt
+    // ist (z.B. aus einem Manifest); der Header wird nicht geprüft
+    static size_t read(fs::FS &fs, const char *path, uint16_t recordSize, uint32_t count,
+                       uint32_t first, void *records, size_t maxRecords);
+    static uint32_t lowerBound(fs::FS &fs, const char *path, uint16_t recordSize, uint32_t count, uint32_t t);
+
+private:
+    static uint32_t offset(uint16_t recordSize, uint32_t index);
+
+    char path[RECORD_FILE_PATH_MAX];
+    uint32_t magic;
+    uint16_t version;
+    uint16_t recordSize;
+    uint16_t channels;
+
+    fs::FS *fs;
+    uint32_t recordCount;
+    uint32_t headerReserved;
+    File writer;
+};
+
+#endif
@@ -0,0 +1,36 @@
+#include "record_source.h"
+#include "sample_ring.h"
+
+LogRangeSource::LogRangeSource(uint32_t first, uint32_t end, int node)
+    : first(first), end(end), nextIndex(first), node(node), blockCount(0), blockPos(0) {
+}
+
+bool LogRangeSource::next(SensorRecord &record) {
+    for (;;) {
+        if (blockPos == blockCount) {
+            if (nextIndex >= end) return false;
+
+            uint32_t wanted = end - nextIndex;
+            if (wanted > RECORD_SOURCE_BLOCK_RECORDS) wanted = RECORD_SOURCE_BLOCK_RECORDS;
+
+            // Was noch im Messwert-Puffer liegt, kommt ohne SD-Zugriff
+            blockCount = sampleRingReadRange(nextIndex, block, wanted);
+            if (blockCount == 0) blockCount = sensorLogReadRange(nextIndex, block, wanted);
+            blockPos = 0;
+            if (blockCount == 0) return false;
+            nextIndex += blockCount;
+        }
+
+        const SensorRecord &candidate = block[blockPos++];
+        if (node >= 0 && candidate.node != node) continue;
+
+        record = candidate;
+        return true;
+    }
+}
+
+void LogRangeSource::rewind() {
+    nextIndex = first;
+    blockCount = 0;
+    blockPos = 0;
+}
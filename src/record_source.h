@@ -0,0 +1,46 @@
+// record_source.h - Datensatzquellen für History-Abfragen
+//
+// Eine RecordSource liefert Datensätze zeitlich aufsteigend, einen pro next().
+// HistoryStream formatiert, was eine Quelle liefert; Quellen lassen sich
+// verschachteln (z.B. Downsampling über einem Log-Ausschnitt).
+#ifndef RECORD_SOURCE_H
+#define RECORD_SOURCE_H
+
+#include <Arduino.h>
+#include "sensor_log.h"
+
+#define RECORD_SOURCE_BLOCK_RECORDS 16
+
+class RecordSource {
+public:
+    virtual ~RecordSource() {}
+
+    // false, wenn keine Datensätze mehr kommen
+    virtual bool next(SensorRecord &record) = 0;
+
+    // Wieder beim ersten Datensatz anfangen
+    virtual void rewind() = 0;
+};
+
+// Datensätze [first, end) aus dem Binär-Log, blockweise gelesen; liegt ein
+// Block noch im Messwert-Puffer (sample_ring.h), wird er von dort kopiert.
+// Mit node >= 0 werden nur die Datensätze dieses Nodes geliefert.
+class LogRangeSource : public RecordSource {
+public:
+    LogRangeSource(uint32_t first, uint32_t end, int node = -1);
+
+    bool next(SensorRecord &record) override;
+    void rewind() override;
+
+private:
+    uint32_t first;
+    uint32_t end;
+    uint32_t nextIndex;
+    int node;
+
+    SensorRecord block[RECORD_SOURCE_BLOCK_RECORDS];
+    size_t blockCount;
+    size_t blockPos;
+};
+
+#endif
@@ -0,0 +1,484 @@
+#include "rollup.h"
+
+static const char *const tierNames[ROLLUP_TIERS] = { "hour", "day" };
+
+// Je Stufe ein Handle zum Schreiben, umgestellt auf die Datei des Nodes, der
+// gerade schreibt - mehr als zwei Dateien bleiben so nie offen
+static RecordFile tierWriters[ROLLUP_TIERS] = {
+    RecordFile("", ROLLUP_MAGIC, ROLLUP_VERSION, sizeof(RollupRecord), SENSOR_LOG_VALUES),
+    RecordFile("", ROLLUP_MAGIC, ROLLUP_VERSION, sizeof(RollupRecord), SENSOR_LOG_VALUES)
+};
+
+static fs::FS *rollupFs = nullptr;
+static bool tierReady[ROLLUP_TIERS];
+
+// Einträge je Stufe und Node; gelesen auch von AsyncTCP (historyOpen())
+static uint32_t nodeCounts[ROLLUP_TIERS][NODE_MAX];
+
+static const uint32_t tierWidths[ROLLUP_TIERS] = { 3600, 86400 };
+
+// Laufendes (letztes) Fenster je Stufe und Node
+struct OpenBucket {
+    RollupRecord entry;
+    uint32_t counts[SENSOR_LOG_VALUES];     // Messungen je Slot, für das Mittel
+    uint32_t index;                         // Platz in der Datei
+    bool active;
+    bool dirty;
+};
+
+static OpenBucket openBuckets[ROLLUP_TIERS][NODE_MAX];
+
+// Platz für das nächste neue Fenster je Stufe und Node; nach rebuildFrom()
+// kleiner als nodeCounts, die Einträge dahinter werden dann überschrieben
+static uint32_t tierEnd[ROLLUP_TIERS][NODE_MAX];
+
+// Tage je Node mit nachgelieferten Sätzen, Bit h von hours = Stunde h (UTC)
+struct StaleDay {
+    uint32_t day;
+    uint32_t hours;
+    uint8_t node;
+};
+
+static StaleDay staleDays[ROLLUP_STALE_MAX];
+static size_t staleCount = 0;
+static uint32_t staleOverflow = 0;      // ältester Tag, der nicht mehr in staleDays passte
+
+static void nodePath(int tier, uint8_t node, char *path, size_t size) {
+    snprintf(path, size, ROLLUP_DIR "/%s_%02u.bin", tierNames[tier], node);
+}
+
+// Stellt den Schreib-Handle der Stufe auf die Datei des Nodes um
+static bool selectNode(int tier, uint8_t node) {
+    char path[RECORD_FILE_PATH_MAX];
+    nodePath(tier, node, path, sizeof(path));
+
+    RecordFile &file = tierWriters[tier];
+    if (file.ready() && strcmp(file.filePath(), path) == 0) return true;
+
+    file.setPath(path);
+    return file.begin(*rollupFs);
+}
+
+static void resetBucket(OpenBucket &bucket, uint32_t start, uint8_t node, uint32_t index) {
+    memset(&bucket, 0, sizeof(bucket));
+    bucket.entry.start = start;
+    bucket.entry.node = node;
+    bucket.index = index;
+    bucket.active = true;
+}
+
+static void accumulate(OpenBucket &bucket, const SensorRecord &record) {
+    RollupRecord &entry = bucket.entry;
+    entry.count++;
+
+    for (int slot = 0; slot < SENSOR_LOG_VALUES; slot++) {
+        if (!(record.valid & (1 << slot))) continue;
+
+        float value = record.values[slot];
+        uint32_t n = ++bucket.counts[slot];
+
+        if (n == 1) {
+            entry.min[slot] = value;
+            entry.max[slot] = value;
+            entry.mean[slot] = value;
+            entry.valid |= 1 << slot;
+            continue;
+        }
+
+        if (value < entry.min[slot]) entry.min[slot] = value;
+        if (value > entry.max[slot]) entry.max[slot] = value;
+        entry.mean[slot] += (value - entry.mean[slot]) / n;
+    }
+}
+
+static void flushBucket(int tier, OpenBucket &bucket) {
+    if (!bucket.active || !bucket.dirty) return;
+
+    uint8_t node = bucket.entry.node;
+    if (selectNode(tier, node) && tierWriters[tier].write(bucket.index, &bucket.entry)) {
+        nodeCounts[tier][node] = tierWriters[tier].count();
+        bucket.dirty = false;
+    } else {
+        Serial.println("Fehler beim Schreiben des Rollups!");
+    }
+}
+
+// Rechnet record in die Stufe ein. Ein neues Fenster wird sofort geschrieben,
+// damit es seinen Platz in der Datei hat; danach nur noch per rollupFlush()
+// und beim Fensterwechsel.
+static void addToTier(int tier, const SensorRecord &record) {
+    if (record.node >= NODE_MAX) return;
+
+    OpenBucket &bucket = openBuckets[tier][record.node];
+    uint32_t start = record.timestamp - record.timestamp % tierWidths[tier];
+    bool opened = false;
+
+    if (!bucket.active || start != bucket.entry.start) {
+        // Zeit läuft rückwärts (z.B. NTP-Korrektur): das alte Fenster nicht wieder öffnen
+        if (bucket.active && start < bucket.entry.start) return;
+
+        flushBucket(tier, bucket);
+        resetBucket(bucket, start, record.node, tierEnd[tier][record.node]++);
+        opened = true;
+    }
+
+    accumulate(bucket, record);
+    bucket.dirty = true;
+
+    if (opened) flushBucket(tier, bucket);
+}
+
+// Öffnet die Datei eines Nodes und merkt sich seinen letzten Eintrag, der
+// neu aufgebaut wird (lastStart, 0 ohne Einträge). false, wenn die Datei
+// verworfen wurde.
+static bool openNode(int tier, uint8_t node, const char *path, uint32_t &lastStart) {
+    lastStart = 0;
+
+    if (!selectNode(tier, node)) {
+        // Abgeleitete Daten: im Zweifel verwerfen und neu aufbauen
+        tierWriters[tier].close();
+        rollupFs->remove(path);
+        return false;
+    }
+
+    uint32_t count = tierWriters[tier].count();
+    nodeCounts[tier][node] = count;
+    tierEnd[tier][node] = count;
+    if (count == 0) return true;
+
+    // Der letzte Eintrag kann beim Ausschalten unvollständig geblieben sein
+    RollupRecord entry;
+    if (tierWriters[tier].read(count - 1, &entry, 1) != 1) return false;
+
+    resetBucket(openBuckets[tier][node], entry.start, node, count - 1);
+    lastStart = entry.start;
+    return true;
+}
+
+// Öffnet eine Stufe. Gibt den Log-Index zurück, ab dem nachgeholt wird: das
+// älteste letzte Fenster aller Nodes. Messungen davor, deren Fenster ein
+// Node schon hat, verwirft addToTier() ("Zeit läuft rückwärts").
+static uint32_t openTier(int tier) {
+    uint32_t oldest = UINT32_MAX;
+    bool complete = true;
+
+    for (int node = 0; node < NODE_MAX; node++) {
+        char path[RECORD_FILE_PATH_MAX];
+        nodePath(tier, node, path, sizeof(path));
+
+        // Jeder angemeldete Node hat eine Datei, sonst ist sie verloren gegangen
+        // und wird (leer angelegt) beim Nachholen neu gefüllt
+        if (!rollupFs->exists(path)) {
+            if (node < nodeCount() && selectNode(tier, node)) complete = false;
+            continue;
+        }
+
+        uint32_t lastStart;
+        if (!openNode(tier, node, path, lastStart)) complete = false;
+        else if (lastStart && lastStart < oldest) oldest = lastStart;
+    }
+
+    tierReady[tier] = true;
+
+    // Noch gar nichts oder eine Datei fehlt: ab dem ältesten Satz, den das Log noch hat
+    if (!complete || oldest == UINT32_MAX) return sensorLogFirstIndex();
+    return sensorLogLowerBound(oldest);
+}
+
+// Rechnet das Log ab resume[tier] bis zum Ende in die Stufen ein
+static void catchUp(const uint32_t *resume) {
+    uint32_t total = sensorLogCount();
+    uint32_t catchUpFrom = total;
+
+    for (int tier = 0; tier < ROLLUP_TIERS; tier++) {
+        if (resume[tier] < catchUpFrom) catchUpFrom = resume[tier];
+    }
+
+    if (catchUpFrom < total) {
+        Serial.printf("Rollups: hole %lu Messungen nach...\n", (unsigned long)(total - catchUpFrom));
+
+        LogRangeSource source(catchUpFrom, total);
+        SensorRecord record;
+
+        for (uint32_t index = catchUpFrom; source.next(record); index++) {
+            for (int tier = 0; tier < ROLLUP_TIERS; tier++) {
+                if (tierReady[tier] && index >= resume[tier]) addToTier(tier, record);
+            }
+        }
+
+        rollupFlush();
+    }
+}
+
+static uint32_t tierTotal(int tier) {
+    uint32_t total = 0;
+    for (int node = 0; node < NODE_MAX; node++) total += nodeCounts[tier][node];
+    return total;
+}
+
+bool rollupBegin(fs::FS &fs) {
+    uint32_t resume[ROLLUP_TIERS];
+
+    rollupFs = &fs;
+    memset(openBuckets, 0, sizeof(openBuckets));
+    memset(nodeCounts, 0, sizeof(nodeCounts));
+    memset(tierEnd, 0, sizeof(tierEnd));
+    staleCount = 0;
+    staleOverflow = 0;
+
+    // Bis Version 2 lagen alle Nodes gemischt in einer Datei je Stufe
+    if (fs.exists(ROLLUP_OLD_HOUR_FILE)) fs.remove(ROLLUP_OLD_HOUR_FILE);
+    if (fs.exists(ROLLUP_OLD_DAY_FILE)) fs.remove(ROLLUP_OLD_DAY_FILE);
+
+    if (!fs.exists(ROLLUP_DIR) && !fs.mkdir(ROLLUP_DIR)) {
+        Serial.println("Fehler beim Anlegen von " ROLLUP_DIR "!");
+        return false;
+    }
+
+    for (int tier = 0; tier < ROLLUP_TIERS; tier++) resume[tier] = openTier(tier);
+    catchUp(resume);
+
+    Serial.printf("Rollups: %lu Stunden-, %lu Tageseinträge\n",
+                  (unsigned long)tierTotal(ROLLUP_HOUR),
+                  (unsigned long)tierTotal(ROLLUP_DAY));
+    return true;
+}
+
+void rollupAdd(const SensorRecord &record) {
+    for (int tier = 0; tier < ROLLUP_TIERS; tier++) {
+        if (tierReady[tier]) addToTier(tier, record);
+    }
+}
+
+// Alle Fenster ab from aus dem Log neu berechnen und an ihrem (nun ggf.
+// verschobenen) Platz überschreiben
+static void rebuildFrom(uint32_t from) {
+    uint32_t resume[ROLLUP_TIERS];
+
+    for (int tier = 0; tier < ROLLUP_TIERS; tier++) {
+        resume[tier] = sensorLogCount();
+        if (!tierReady[tier]) continue;
+
+        // Ältere Fenster bleiben, wie sie sind; offene davor noch sichern
+        uint32_t start = from - from % tierWidths[tier];
+        for (int node = 0; node < NODE_MAX; node++) {
+            flushBucket(tier, openBuckets[tier][node]);
+            tierEnd[tier][node] = rollupLowerBound((RollupTier)tier, node, start);
+        }
+        memset(openBuckets[tier], 0, sizeof(openBuckets[tier]));
+
+        resume[tier] = sensorLogLowerBound(start);
+    }
+
+    catchUp(resume);
+
+    // Es kommen nur Messungen hinzu, jedes alte Fenster ist also wieder belegt
+    for (int tier = 0; tier < ROLLUP_TIERS; tier++) {
+        for (int node = 0; node < NODE_MAX; node++) {
+            if (tierEnd[tier][node] < nodeCounts[tier][node]) {
+                Serial.printf("Rollups: %s von Node %d hat nach dem Neuaufbau alte Einträge am Ende!\n",
+                              tierNames[tier], node);
+            }
+        }
+    }
+}
+
+// Setzt ein neu berechnetes Fenster ein: das gleiche offene wird im RAM
+// ersetzt, ein neueres wird das offene, ein älteres kommt an seinen Platz in
+// der Datei. Fehlt es dort, rücken die Einträge dahinter einen Platz auf.
+static void replaceWindow(int tier, OpenBucket &rebuilt) {
+    if (!tierReady[tier] || !rebuilt.active) return;
+
+    uint8_t node = rebuilt.entry.node;
+    OpenBucket &open = openBuckets[tier][node];
+    rebuilt.dirty = true;
+
+    if (open.active && rebuilt.entry.start == open.entry.start) {
+        rebuilt.index = open.index;
+        open = rebuilt;
+        return;
+    }
+
+    if (!open.active || rebuilt.entry.start > open.entry.start) {
+        flushBucket(tier, open);
+        rebuilt.index = tierEnd[tier][node]++;
+        open = rebuilt;
+        flushBucket(tier, open);
+        return;
+    }
+
+    flushBucket(tier, open);
+    if (!selectNode(tier, node)) {
+        Serial.println("Fehler beim Schreiben des Rollups!");
+        return;
+    }
+
+    RecordFile &file = tierWriters[tier];
+    uint32_t end = tierEnd[tier][node];
+    uint32_t index = file.lowerBound(rebuilt.entry.start);
+    if (index > end) index = end;
+
+    RollupRecord block[8];
+    bool exists = index < end && file.read(index, block, 1) == 1 && block[0].start == rebuilt.entry.start;
+
+    if (!exists) {
+        // Von hinten blockweise aufrücken, das offene Fenster eingeschlossen
+        for (uint32_t pos = end; pos > index;) {
+            uint32_t count = pos - index;
+            if (count > sizeof(block) / sizeof(block[0])) count = sizeof(block) / sizeof(block[0]);
+            pos -= count;
+
+            if (file.read(pos, block, count) != count || !file.write(pos + 1, block, count)) {
+                Serial.println("Fehler beim Verschieben des Rollups!");
+                return;
+            }
+        }
+        tierEnd[tier][node]++;
+        open.index++;
+    }
+
+    if (file.write(index, &rebuilt.entry)) {
+        nodeCounts[tier][node] = file.count();
+    } else {
+        Serial.println("Fehler beim Schreiben des Rollups!");
+    }
+}
+
+// Liest die Partition des Tages und ersetzt das Tagesfenster und die
+// vorgemerkten Stundenfenster des Nodes
+static void rebuildDay(const StaleDay &stale) {
+    OpenBucket day;
+    OpenBucket hour;
+    resetBucket(day, stale.day, stale.node, 0);
+    memset(&hour, 0, sizeof(hour));
+
+    LogRangeSource source(sensorLogLowerBound(stale.day),
+                          sensorLogLowerBound(stale.day + tierWidths[ROLLUP_DAY]));
+    SensorRecord record;
+
+    for (;;) {
+        bool more = source.next(record);
+        if (more && record.node != stale.node) continue;
+
+        uint32_t start = more ? record.timestamp - record.timestamp % tierWidths[ROLLUP_HOUR] : 0;
+        if (hour.active && (!more || start != hour.entry.start)) {
+            uint32_t bit = (hour.entry.start - stale.day) / tierWidths[ROLLUP_HOUR];
+            if (stale.hours & ((uint32_t)1 << bit)) replaceWindow(ROLLUP_HOUR, hour);
+            hour.active = false;
+        }
+        if (!more) break;
+
+        if (!hour.active) resetBucket(hour, start, stale.node, 0);
+        accumulate(hour, record);
+        accumulate(day, record);
+    }
+
+    if (day.entry.count > 0) replaceWindow(ROLLUP_DAY, day);
+}
+
+void rollupInvalidate(const SensorRecord &record) {
+    if (record.node >= NODE_MAX) return;
+
+    uint32_t day = record.timestamp - record.timestamp % tierWidths[ROLLUP_DAY];
+    uint32_t hour = (uint32_t)1 << (record.timestamp - day) / tierWidths[ROLLUP_HOUR];
+
+    for (size_t i = 0; i < staleCount; i++) {
+        if (staleDays[i].day == day && staleDays[i].node == record.node) {
+            staleDays[i].hours |= hour;
+            return;
+        }
+    }
+
+    if (staleCount < ROLLUP_STALE_MAX) {
+        staleDays[staleCount++] = { day, hour, record.node };
+    } else if (!staleOverflow || day < staleOverflow) {
+        staleOverflow = day;
+    }
+}
+
+bool rollupRebuildStale() {
+    if (staleOverflow) {
+        uint32_t from = staleOverflow;
+        for (size_t i = 0; i < staleCount; i++) {
+            if (staleDays[i].day < from) from = staleDays[i].day;
+        }
+
+        rebuildFrom(from);
+        staleOverflow = 0;
+        staleCount = 0;
+        return true;
+    }
+
+    if (staleCount == 0) return false;
+
+    rebuildDay(staleDays[--staleCount]);
+    return true;
+}
+
+void rollupFlush() {
+    for (int tier = 0; tier < ROLLUP_TIERS; tier++) {
+        for (int node = 0; node < NODE_MAX; node++) flushBucket(tier, openBuckets[tier][node]);
+    }
+}
+
+bool rollupReady(RollupTier tier) {
+    return tierReady[tier];
+}
+
+uint32_t rollupWidth(RollupTier tier) {
+    return tierWidths[tier];
+}
+
+uint32_t rollupCount(RollupTier tier, uint8_t node) {
+    return node < NODE_MAX ? nodeCounts[tier][node] : 0;
+}
+
+size_t rollupReadRange(RollupTier tier, uint8_t node, uint32_t first, RollupRecord *records, size_t maxRecords) {
+    if (!tierReady[tier] || node >= NODE_MAX) return 0;
+
+    char path[RECORD_FILE_PATH_MAX];
+    nodePath(tier, node, path, sizeof(path));
+    return RecordFile::read(*rollupFs, path, sizeof(RollupRecord), nodeCounts[tier][node], first, records, maxRecords);
+}
+
+uint32_t rollupLowerBound(RollupTier tier, uint8_t node, uint32_t t) {
+    if (!tierReady[tier] || node >= NODE_MAX) return 0;
+
+    char path[RECORD_FILE_PATH_MAX];
+    nodePath(tier, node, path, sizeof(path));
+    return RecordFile::lowerBound(*rollupFs, path, sizeof(RollupRecord), nodeCounts[tier][node], t);
+}
+
+RollupSource::RollupSource(RollupTier tier, uint32_t first, uint32_t end, uint8_t node, HistoryAgg agg)
+    : tier(tier), first(first), end(end), nextIndex(first), node(node), agg(agg), blockCount(0), blockPos(0) {
+}
+
+bool RollupSource::next(SensorRecord &record) {
+    if (blockPos == blockCount) {
+        if (nextIndex >= end) return false;
+
+        uint32_t wanted = end - nextIndex;
+        if (wanted > sizeof(block) / sizeof(block[0])) wanted = sizeof(block) / sizeof(block[0]);
+
+        blockCount = rollupReadRange(tier, node, nextIndex, block, wanted);
+        blockPos = 0;
+        if (blockCount == 0) return false;
+        nextIndex += blockCount;
+    }
+
+    const RollupRecord &entry = block[blockPos++];
+    const float *values = agg == AGG_MIN ? entry.min : agg == AGG_MAX ? entry.max : entry.mean;
+
+    memset(&record, 0, sizeof(record));
+    record.timestamp = entry.start + tierWidths[tier] / 2;
+    record.node = entry.node;
+    record.valid = entry.valid;
+    memcpy(record.values, values, sizeof(record.values));
+    return true;
+}
+
+void RollupSource::rewind() {
+    nextIndex = first;
+    blockCount = 0;
+    blockPos = 0;
+}
@@ -0,0 +1,106 @@
+// rollup.h - Stündliche und tägliche Verdichtung des Binär-Logs
+//
+// Zu jeder geloggten Messung (storage-Task) wird der laufende Stunden- und Tageseintrag
+// ihres Nodes (min, max, Mittel je Kanal, Anzahl) im RAM aktualisiert und an
+// seinem Platz in der Datei des Nodes (/rollup/hour_03.bin bzw.
+// /rollup/day_03.bin für Node 3) überschrieben - beim Fensterwechsel und mit
+// rollupFlush() zusammen mit dem Log. Was dabei verloren geht, baut
+// rollupBegin() aus dem Log neu auf. Fenstergrenzen sind UTC (volle Stunde /
+// 00:00 UTC).
+//
+// Eine Datei je Node, damit eine Abfrage nur die Einträge ihres Nodes liest
+// und per binärer Suche direkt an den Anfang springt. Offen bleibt je Stufe
+// nur die zuletzt geschriebene Datei.
+//
+// Lange Zeiträume liest historyOpen() aus der gröbsten passenden Stufe:
+// ein Jahr sind ~365 Tageseinträge pro Node statt ~525.000 Messungen.
+#ifndef ROLLUP_H
+#define ROLLUP_H
+
+#include <Arduino.h>
+#include "FS.h"
+#include "sensor_log.h"
+#include "node_registry.h"
+#include "record_source.h"
+#include "downsample.h"
+
+#define ROLLUP_DIR              "/rollup"
+#define ROLLUP_OLD_HOUR_FILE    "/rollup_hour.bin"  // bis Version 2: alle Nodes in einer Datei
+#define ROLLUP_OLD_DAY_FILE     "/rollup_day.bin"
+#define ROLLUP_MAGIC            0x55525348UL        // "HSRU"
+#define ROLLUP_VERSION          4
+#define ROLLUP_STALE_MAX        16                  // vorgemerkte Tage x Nodes nach Nachlieferungen
+
+enum RollupTier {
+    ROLLUP_HOUR = 0,
+    ROLLUP_DAY,
+    ROLLUP_TIERS
+};
+
+struct RollupRecord {
+    uint32_t start;                         // Fensterbeginn, Unix-Zeit
+    uint32_t count;                         // Anzahl Messungen im Fenster (1 Hz: 86400 am Tag)
+    uint8_t node;
+    uint8_t valid;                          // Bit i = Slot i hat Werte
+    uint16_t reserved;
+    float min[SENSOR_LOG_VALUES];
+    float max[SENSOR_LOG_VALUES];
+    float mean[SENSOR_LOG_VALUES];
+};
+
+static_assert(sizeof(RollupRecord) == 84, "RollupRecord muss 84 Byte haben");
+
+// Öffnet die Stufen und holt fehlende Einträge aus dem Binär-Log nach
+// (beim ersten Start nach der Umstellung einmal das ganze Log). Dateien in
+// einem alten Format werden verworfen und neu aufgebaut.
+// Muss nach sensorLogBegin() laufen.
+bool rollupBegin(fs::FS &fs);
+
+// Neue Messung in alle Stufen einrechnen
+void rollupAdd(const SensorRecord &record);
+
+// Geänderte offene Einträge schreiben
+void rollupFlush();
+
+// Für sensorLogMerge() (onInserted): Stunden- und Tagesfenster eines
+// eingefügten Satzes zum Neuberechnen vormerken
+void rollupInvalidate(const SensorRecord &record);
+
+// Berechnet die vorgemerkten Fenster eines Tages und Nodes aus dessen
+// Partition neu und ersetzt sie; fehlt ein Fenster in der Datei, rücken die
+// Einträge dahinter einen Platz auf. Ein Tag pro Aufruf, false, wenn nichts
+// vorgemerkt war. Waren es mehr als ROLLUP_STALE_MAX, wird stattdessen ab dem
+// ältesten alles neu berechnet.
+bool rollupRebuildStale();
+
+bool rollupReady(RollupTier tier);
+uint32_t rollupWidth(RollupTier tier);
+
+// Indizes zählen je Node in dessen eigener Datei
+uint32_t rollupCount(RollupTier tier, uint8_t node);
+size_t rollupReadRange(RollupTier tier, uint8_t node, uint32_t first, RollupRecord *records, size_t maxRecords);
+uint32_t rollupLowerBound(RollupTier tier, uint8_t node, uint32_t t);
+
+// Einträge [first, end) aus der Datei eines Nodes als SensorRecord: je nach
+// agg min, max oder Mittel, Zeitstempel = Fenstermitte
+class RollupSource : public RecordSource {
+public:
+    RollupSource(RollupTier tier, uint32_t first, uint32_t end, uint8_t node, HistoryAgg agg);
+
+    bool next(SensorRecord &record) override;
+    void rewind() override;
+
+private:
+    RollupTier tier;
+    uint32_t first;
+    uint32_t end;
+    uint32_t nextIndex;
+    uint8_t node;
+    HistoryAgg agg;
+
+    RollupRecord block[16];
+    size_t blockCount;
+    size_t blockPos;
+};
+
+#endif
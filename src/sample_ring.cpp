@@ -0,0 +1,173 @@
+#include "sample_ring.h"
+
+static SensorRecord *ring = nullptr;
+static uint32_t capacity = 0;
+static uint32_t firstIndex = 0;     // Log-Index des ältesten Eintrags
+static uint32_t size = 0;
+static uint32_t shift = 0;          // um so viel sind die Indizes seit dem Laden weitergerückt
+
+static portMUX_TYPE ringMux = portMUX_INITIALIZER_UNLOCKED;
+
+static SensorRecord &slot(uint32_t index) {
+    return ring[(index - shift) % capacity];
+}
+
+// Stellt den Puffer auf die Log-Indizes first..total-1; die Einträge bis keep
+// stehen schon darin, der Rest wird von der Karte gelesen. Gibt die Anzahl
+// der Einträge zurück.
+static uint32_t fill(uint32_t first, uint32_t keep, uint32_t total) {
+    portENTER_CRITICAL(&ringMux);
+    firstIndex = first;
+    size = keep - first;
+    if (size == 0) shift = 0;
+    portEXIT_CRITICAL(&ringMux);
+
+    // Blockweise laden; geschrieben wird direkt in die Ringplätze,
+    // die Einträge werden erst danach unter dem Lock freigegeben
+    uint32_t index = keep;
+    while (index < total) {
+        uint32_t wanted = total - index;
+        if (wanted > 32) wanted = 32;
+
+        // Die Indizes first..total-1 liegen hintereinander, solange sie nicht über das Pufferende laufen
+        uint32_t untilWrap = capacity - (index - shift) % capacity;
+        if (wanted > untilWrap) wanted = untilWrap;
+
+        size_t count = sensorLogReadRange(index, &slot(index), wanted);
+        if (count == 0) break;
+        index += count;
+    }
+
+    portENTER_CRITICAL(&ringMux);
+    size = index - first;
+    portEXIT_CRITICAL(&ringMux);
+
+    return index - first;
+}
+
+// Erster Index, den der Puffer beim aktuellen Log halten kann
+static uint32_t firstToLoad() {
+    uint32_t total = sensorLogCount();
+    uint32_t oldest = sensorLogFirstIndex();
+    return total > oldest + capacity ? total - capacity : oldest;
+}
+
+bool sampleRingBegin() {
+    if (!ring) {
+        if (psramFound()) {
+            capacity = SAMPLE_RING_PSRAM_CAPACITY;
+            ring = (SensorRecord *)ps_malloc(capacity * sizeof(SensorRecord));
+        } else {
+            capacity = SAMPLE_RING_HEAP_CAPACITY;
+            ring = (SensorRecord *)malloc(capacity * sizeof(SensorRecord));
+        }
+
+        if (!ring) {
+            capacity = 0;
+            Serial.println("Kein Speicher für den Messwert-Puffer!");
+            return false;
+        }
+    }
+
+    uint32_t first = firstToLoad();
+    uint32_t loaded = fill(first, first, sensorLogCount());
+
+    Serial.printf("Messwert-Puffer: %lu von %lu Plätzen (%s)\n",
+                  (unsigned long)loaded, (unsigned long)capacity,
+                  psramFound() ? "PSRAM" : "Heap");
+    return true;
+}
+
+void sampleRingPush(uint32_t index, const SensorRecord &record) {
+    if (!ring) return;
+
+    portENTER_CRITICAL(&ringMux);
+
+    if (index != firstIndex + size) {
+        firstIndex = index;
+        size = 0;
+        shift = 0;
+    }
+
+    slot(index) = record;
+
+    if (size < capacity) size++;
+    else firstIndex++;
+
+    portEXIT_CRITICAL(&ringMux);
+}
+
+void sampleRingMerged(uint32_t from, uint32_t to, uint32_t inserted) {
+    if (!ring || size == 0 || inserted == 0) return;
+
+    // Alter Index des ersten Satzes nach dem jüngsten eingefügten; ab dort
+    // hat sich nur der Index verschoben
+    uint32_t moved = sensorLogLowerBound(to + 1) - inserted;
+    if (firstIndex >= moved) {
+        portENTER_CRITICAL(&ringMux);
+        firstIndex += inserted;
+        shift += inserted;
+        portEXIT_CRITICAL(&ringMux);
+        return;
+    }
+
+    // Vor dem ersten eingefügten ist alles beim Alten
+    uint32_t first = firstToLoad();
+    uint32_t keep = sensorLogLowerBound(from);
+    if (keep > firstIndex + size) keep = firstIndex + size;
+    if (first < firstIndex || keep < first) keep = first;
+
+    fill(first, keep, sensorLogCount());
+}
+
+size_t sampleRingReadRange(uint32_t first, SensorRecord *records, size_t maxRecords) {
+    if (!ring) return 0;
+
+    size_t count = 0;
+
+    portENTER_CRITICAL(&ringMux);
+    if (first >= firstIndex && first < firstIndex + size) {
+        count = firstIndex + size - first;
+        if (count > maxRecords) count = maxRecords;
+
+        for (size_t i = 0; i < count; i++) {
+            records[i] = slot(first + i);
+        }
+    }
+    portEXIT_CRITICAL(&ringMux);
+
+    return count;
+}
+
+bool sampleRingLowerBound(uint32_t t, uint32_t &index) {
+    if (!ring) return false;
+
+    bool found = false;
+
+    portENTER_CRITICAL(&ringMux);
+    if (size > 0 && slot(firstIndex).timestamp <= t) {
+        uint32_t low = firstIndex;
+        uint32_t high = firstIndex + size;
+
+        while (low < high) {
+            uint32_t mid = low + (high - low) / 2;
+
+            if (slot(mid).timestamp < t) low = mid + 1;
+            else high = mid;
+        }
+
+        index = low;
+        found = true;
+    }
+    portEXIT_CRITICAL(&ringMux);
+
+    return found;
+}
+
+uint32_t sampleRingSize() {
+    return size;
+}
+
+uint32_t sampleRingCapacity() {
+    return capacity;
+}
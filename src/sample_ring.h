@@ -0,0 +1,45 @@
+// sample_ring.h - Die letzten Messungen im RAM, damit /sd-data nicht auf die Karte muss
+//
+// Spiegelt das Ende des Binär-Logs: der Ringpuffer-Eintrag mit Index i ist
+// derselbe Datensatz wie sensorLogRead(i), ein Eintrag je Messung eines
+// Nodes. Mit PSRAM fasst er 1 MB, das sind 48 h Minutenwerte von elf Nodes;
+// ohne PSRAM 90 KB auf dem Heap (24 h Minutenwerte von ESP32 + Pico). Beim
+// Start wird er aus dem Log vorgeladen, danach schiebt der storage-Task jede
+// neue Messung hinein.
+//
+// Geschrieben wird aus dem storage-Task, gelesen aus dem AsyncTCP-Task; jeder
+// Zugriff läuft daher kurz unter einem Spinlock.
+#ifndef SAMPLE_RING_H
+#define SAMPLE_RING_H
+
+#include <Arduino.h>
+#include "sensor_log.h"
+
+#define SAMPLE_RING_PSRAM_CAPACITY 32768    // Datensätze, 1 MB
+#define SAMPLE_RING_HEAP_CAPACITY  2880     // 90 KB, 2 Nodes x 1440 Minuten
+
+// Puffer anlegen und mit dem Ende des Logs füllen. Muss nach sensorLogBegin() laufen.
+bool sampleRingBegin();
+
+// Datensatz mit Log-Index index anhängen. Passt der Index nicht an das Ende,
+// beginnt der Puffer neu ab index.
+void sampleRingPush(uint32_t index, const SensorRecord &record);
+
+// Nach sensorLogMerge(), das inserted Sätze mit Zeitstempeln from..to
+// eingefügt hat: Einträge vor dem ersten eingefügten bleiben, liegen alle
+// danach, rücken nur ihre Indizes weiter. Nur der Teil dazwischen wird aus
+// dem Log nachgeladen.
+void sampleRingMerged(uint32_t from, uint32_t to, uint32_t inserted);
+
+// Kopiert ab Log-Index first so viele Datensätze, wie am Stück im Puffer
+// liegen (höchstens maxRecords). 0, wenn first nicht (mehr) im Puffer ist.
+size_t sampleRingReadRange(uint32_t first, SensorRecord *records, size_t maxRecords);
+
+// Wie sensorLogLowerBound(), aber nur aus dem RAM. false, wenn t vor dem
+// ältesten Eintrag liegt und die Antwort deshalb nicht im Puffer steht.
+bool sampleRingLowerBound(uint32_t t, uint32_t &index);
+
+uint32_t sampleRingSize();
+uint32_t sampleRingCapacity();
+
+#endif
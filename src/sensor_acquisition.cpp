@@ -0,0 +1,108 @@
+#include "sensor_acquisition.h"
+#include <time.h>
+
+enum AcquisitionState {
+    ACQ_IDLE,
+    ACQ_CONVERTING
+};
+
+static TwoWire *wire = nullptr;
+static Adafruit_BMP280 *bmp = nullptr;
+static unsigned long interval = 60000;
+
+static AcquisitionState state = ACQ_IDLE;
+static unsigned long triggeredAt = 0;
+static unsigned long lastPoll = 0;
+static bool started = false;
+static uint32_t errors = 0;
+static LocalReading current;
+
+void acquisitionBegin(TwoWire &w, Adafruit_BMP280 &b, unsigned long intervalMs) {
+    wire = &w;
+    bmp = &b;
+    interval = intervalMs;
+    state = ACQ_IDLE;
+    started = false;
+}
+
+uint32_t acquisitionErrors() {
+    return errors;
+}
+
+// Messbefehl 0xAC 0x33 0x00 laut Datenblatt
+static bool triggerAht20() {
+    wire->beginTransmission(AHT20_ADDRESS);
+    wire->write(0xAC);
+    wire->write(0x33);
+    wire->write(0x00);
+    return wire->endTransmission() == 0;
+}
+
+// Status + 5 Datenbytes; false, solange der Sensor noch misst
+static bool readAht20(float &temperature, float &humidity, bool &failed) {
+    uint8_t data[6];
+    failed = false;
+
+    if (wire->requestFrom((uint8_t)AHT20_ADDRESS, (uint8_t)sizeof(data)) != sizeof(data)) {
+        failed = true;
+        return false;
+    }
+    for (size_t i = 0; i < sizeof(data); i++) data[i] = wire->read();
+
+    // Bit 7 im Status: Messung läuft noch
+    if (data[0] & 0x80) return false;
+
+    uint32_t rawHumidity = ((uint32_t)data[1] << 12) | ((uint32_t)data[2] << 4) | (data[3] >> 4);
+    uint32_t rawTemperature = ((uint32_t)(data[3] & 0x0F) << 16) | ((uint32_t)data[4] << 8) | data[5];
+
+    humidity = rawHumidity * 100.0f / 1048576.0f;
+    temperature = rawTemperature * 200.0f / 1048576.0f - 50.0f;
+    return true;
+}
+
+bool acquisitionPoll(LocalReading &reading) {
+    if (!wire || !bmp) return false;
+
+    unsigned long now = millis();
+
+    switch (state) {
+        case ACQ_IDLE:
+            if (started && now - triggeredAt < interval) return false;
+
+            if (!triggerAht20()) {
+                errors++;
+                triggeredAt = now;      // nächster Versuch nach einem Intervall
+                started = true;
+                return false;
+            }
+
+            triggeredAt = now;
+            lastPoll = now;
+            started = true;
+            current.timestamp = (uint32_t)time(nullptr);
+            current.pressure = bmp->readPressure() / 100.0F;
+            state = ACQ_CONVERTING;
+            return false;
+
+        case ACQ_CONVERTING: {
+            if (now - triggeredAt < AHT20_CONVERSION_MS || now - lastPoll < AHT20_RETRY_MS) return false;
+            lastPoll = now;
+
+            bool failed;
+            if (readAht20(current.temperature, current.humidity, failed)) {
+                state = ACQ_IDLE;
+                reading = current;
+                return true;
+            }
+
+            if (failed || now - triggeredAt > AHT20_TIMEOUT_MS) {
+                Serial.println("AHT20 antwortet nicht, Messung verworfen");
+                errors++;
+                state = ACQ_IDLE;
+            }
+            return false;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,43 @@
+// sensor_acquisition.h - Lokale Sensoren (AHT20 + BMP280) ohne zu blockieren
+//
+// Adafruit_AHTX0::getEvent() stößt die Messung an und wartet dann ~80 ms
+// auf das Ergebnis. Hier ist das in zwei Schritte geteilt, die der
+// acquisition-Task (pipeline.h) über acquisitionPoll() abwechselnd ausführt:
+//
+//   IDLE        Intervall abgelaufen: AHT20-Messung anstoßen, Zeitstempel und
+//               BMP280-Druck sofort festhalten (der BMP280 misst im Normal-
+//               Modus laufend, Lesen kostet nur einen I2C-Transfer)
+//   CONVERTING  nach AHT20_CONVERSION_MS Ergebnis abholen; ist der Sensor
+//               noch beschäftigt, wird alle AHT20_RETRY_MS erneut gefragt
+//
+// Jeder Aufruf kostet höchstens einen kurzen I2C-Transfer, dazwischen laufen
+// die anderen Tasks weiter. Damit sind auch Intervalle von 1 s und weniger möglich.
+#ifndef SENSOR_ACQUISITION_H
+#define SENSOR_ACQUISITION_H
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <Adafruit_BMP280.h>
+
+#define AHT20_ADDRESS           0x38
+#define AHT20_CONVERSION_MS     80
+#define AHT20_RETRY_MS          10
+#define AHT20_TIMEOUT_MS        500
+
+struct LocalReading {
+    uint32_t timestamp;         // Unix-Zeit beim Anstoßen der Messung
+    float temperature;          // °C, roh (ohne Kalibrierung)
+    float humidity;             // %
+    float pressure;             // hPa
+};
+
+// Sensoren müssen bereits mit begin() initialisiert sein (Kalibrierung des AHT20)
+void acquisitionBegin(TwoWire &wire, Adafruit_BMP280 &bmp, unsigned long intervalMs);
+
+// Regelmäßig aufrufen; true, wenn reading eine neue, vollständige Messung enthält
+bool acquisitionPoll(LocalReading &reading);
+
+// Fehlgeschlagene Messungen seit dem Start (Timeout, I2C-Fehler)
+uint32_t acquisitionErrors();
+
+#endif
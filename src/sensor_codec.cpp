@@ -0,0 +1,403 @@
+#include "sensor_codec.h"
+#include "record_file.h"
+#include "metrics.h"
+
+#define CODEC_NODE_BITS 5
+
+static_assert(NODE_MAX <= (1 << CODEC_NODE_BITS), "Node-Index passt nicht in CODEC_NODE_BITS");
+
+// Zuletzt decodierter Block, geteilt von allen Lesern (AsyncTCP, storage)
+struct DecodeCache {
+    char path[RECORD_FILE_PATH_MAX];    // leer = nichts im Puffer
+    uint32_t block;
+    size_t count;
+    SensorRecord records[SENSOR_CODEC_BLOCK_RECORDS];
+    uint8_t data[SENSOR_CODEC_MAX_BLOCK_BYTES];
+    SensorCodecState state;
+};
+
+// Arbeitsspeicher beim Komprimieren, nur solange es läuft
+struct EncodeWorkspace {
+    SensorRecord records[SENSOR_CODEC_BLOCK_RECORDS];
+    uint8_t data[SENSOR_CODEC_MAX_BLOCK_BYTES];
+    SensorCodecState state;
+};
+
+static DecodeCache *cache = nullptr;
+static SemaphoreHandle_t cacheLock = NULL;
+
+struct BitWriter {
+    uint8_t *data;
+    size_t capacity;
+    size_t bits;
+    bool overflow;
+
+    // Höchstwertiges Bit zuerst
+    void put(uint32_t value, int count) {
+        for (int i = count - 1; i >= 0; i--) {
+            size_t byte = bits >> 3;
+            if (byte >= capacity) {
+                overflow = true;
+                return;
+            }
+            if ((bits & 7) == 0) data[byte] = 0;
+            if ((value >> i) & 1) data[byte] |= 0x80 >> (bits & 7);
+            bits++;
+        }
+    }
+};
+
+struct BitReader {
+    const uint8_t *data;
+    size_t bits;
+    size_t pos;
+    bool overflow;
+
+    uint32_t get(int count) {
+        uint32_t value = 0;
+        for (int i = 0; i < count; i++) {
+            if (pos >= bits) {
+                overflow = true;
+                return 0;
+            }
+            value = (value << 1) | ((data[pos >> 3] >> (7 - (pos & 7))) & 1);
+            pos++;
+        }
+        return value;
+    }
+
+    // Anzahl Einsen vor der ersten 0, höchstens max (dann ohne abschließende 0)
+    int prefix(int max) {
+        int ones = 0;
+        while (ones < max && get(1)) ones++;
+        return ones;
+    }
+};
+
+static uint32_t zigzag(int32_t value) {
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static int32_t unzigzag(uint32_t value) {
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+static void resetState(SensorCodecState &state) {
+    memset(&state, 0, sizeof(state));
+}
+
+// Präfix-Stufen: Stufe i sind i Einsen, eine 0 und bits[i] Nutzbits. Bei
+// den Zeitstempeln fehlt der letzten Stufe die 0 (1111+32), bei den Werten
+// nicht - dort ist 11111 das Zeichen für einen unveränderten float.
+static void putStaged(BitWriter &out, uint32_t value, const uint8_t *bits, int stages, bool closeLast) {
+    for (int stage = 0; stage < stages; stage++) {
+        bool last = stage == stages - 1;
+        if (!last && bits[stage] < 32 && value >= (1UL << bits[stage])) continue;
+
+        out.put((1UL << stage) - 1, stage);
+        if (!last || closeLast) out.put(0, 1);
+        out.put(value, bits[stage]);
+        return;
+    }
+}
+
+static const uint8_t timestampBits[] = { 0, 7, 9, 12, 32 };
+static const uint8_t valueBits[] = { 0, 4, 8, 16, 32 };
+#define STAGES 5
+#define VALUE_RAW_PREFIX 0x1F       // 11111: danach der float unverändert
+
+static bool quantize(float value, int32_t &q) {
+    if (!isfinite(value) || fabs(value * SENSOR_CODEC_SCALE) >= 1e9) return false;
+    q = (int32_t)lround(value * SENSOR_CODEC_SCALE);
+    return true;
+}
+
+size_t sensorCodecEncode(SensorCodecState &state, const SensorRecord *records, size_t count,
+                         uint8_t *out, size_t maxLen) {
+    BitWriter writer = { out, maxLen, 0, false };
+    resetState(state);
+
+    for (size_t i = 0; i < count; i++) {
+        const SensorRecord &record = records[i];
+        if (record.node >= NODE_MAX) return 0;
+
+        if (i == 0) {
+            writer.put(record.timestamp, 32);
+        } else {
+            uint32_t delta = record.timestamp - state.timestamp;
+            putStaged(writer, zigzag((int32_t)(delta - state.delta)), timestampBits, STAGES, false);
+            state.delta = delta;
+        }
+        state.timestamp = record.timestamp;
+
+        writer.put(record.node, CODEC_NODE_BITS);
+
+        if (state.seen[record.node] && state.valid[record.node] == record.valid) {
+            writer.put(0, 1);
+        } else {
+            writer.put(1, 1);
+            writer.put(record.valid, 8);
+        }
+        state.seen[record.node] = true;
+        state.valid[record.node] = record.valid;
+
+        if (record.reserved == 0) {
+            writer.put(0, 1);
+        } else {
+            writer.put(1, 1);
+            writer.put(record.reserved, 16);
+        }
+
+        for (int slot = 0; slot < SENSOR_LOG_VALUES; slot++) {
+            if (!(record.valid & (1 << slot))) continue;
+
+            int32_t q;
+            if (!quantize(record.values[slot], q)) {
+                uint32_t raw;
+                memcpy(&raw, &record.values[slot], sizeof(raw));
+                writer.put(VALUE_RAW_PREFIX, 5);
+                writer.put(raw, 32);
+                continue;
+            }
+
+            int32_t &previous = state.values[record.node][slot];
+            putStaged(writer, zigzag((int32_t)((uint32_t)q - (uint32_t)previous)), valueBits, STAGES, true);
+            previous = q;
+        }
+    }
+
+    if (writer.overflow) return 0;
+    return (writer.bits + 7) / 8;
+}
+
+bool sensorCodecDecode(SensorCodecState &state, const uint8_t *data, size_t len,
+                       SensorRecord *records, size_t count) {
+    BitReader reader = { data, len * 8, 0, false };
+    resetState(state);
+
+    for (size_t i = 0; i < count; i++) {
+        SensorRecord &record = records[i];
+        memset(&record, 0, sizeof(record));
+
+        if (i == 0) {
+            record.timestamp = reader.get(32);
+        } else {
+            state.delta += (uint32_t)unzigzag(reader.get(timestampBits[reader.prefix(STAGES - 1)]));
+            record.timestamp = state.timestamp + state.delta;
+        }
+        state.timestamp = record.timestamp;
+
+        record.node = reader.get(CODEC_NODE_BITS);
+        record.valid = reader.get(1) ? reader.get(8) : state.valid[record.node];
+        state.valid[record.node] = record.valid;
+        if (reader.get(1)) record.reserved = reader.get(16);
+
+        for (int slot = 0; slot < SENSOR_LOG_VALUES; slot++) {
+            if (!(record.valid & (1 << slot))) continue;
+
+            int stage = reader.prefix(STAGES);
+            if (stage == STAGES) {
+                uint32_t raw = reader.get(32);
+                memcpy(&record.values[slot], &raw, sizeof(raw));
+                continue;
+            }
+
+            int32_t &previous = state.values[record.node][slot];
+            previous = (int32_t)((uint32_t)previous + (uint32_t)unzigzag(reader.get(valueBits[stage])));
+            record.values[slot] = (float)(previous / SENSOR_CODEC_SCALE);
+        }
+
+        if (reader.overflow) return false;
+    }
+
+    return true;
+}
+
+bool sensorCodecBegin() {
+    if (!cacheLock) cacheLock = xSemaphoreCreateMutex();
+    if (!cache) {
+        cache = (DecodeCache *)(psramFound() ? ps_malloc(sizeof(DecodeCache)) : malloc(sizeof(DecodeCache)));
+        if (!cache) {
+            Serial.println("Kein Speicher für den Log-Decoder!");
+            return false;
+        }
+        cache->path[0] = '\0';
+    }
+    return cacheLock != NULL;
+}
+
+static bool readHeader(File &file, SensorCodecHeader &header) {
+    return file.read((uint8_t *)&header, sizeof(header)) == sizeof(header)
+        && header.magic == SENSOR_CODEC_MAGIC
+        && header.version == SENSOR_CODEC_VERSION
+        && header.blockRecords == SENSOR_CODEC_BLOCK_RECORDS;
+}
+
+static bool readRef(File &file, uint32_t block, SensorCodecBlockRef &ref) {
+    return file.seek(sizeof(SensorCodecHeader) + block * sizeof(SensorCodecBlockRef))
+        && file.read((uint8_t *)&ref, sizeof(ref)) == sizeof(ref);
+}
+
+// Block in den Puffer holen, falls er nicht schon dort liegt. Nur unter cacheLock.
+static bool loadBlock(File &file, const SensorCodecHeader &header, const char *path, uint32_t block) {
+    if (cache->block == block && strcmp(cache->path, path) == 0) return true;
+    cache->path[0] = '\0';
+
+    SensorCodecBlockRef refs[2];
+    if (!file.seek(sizeof(SensorCodecHeader) + block * sizeof(SensorCodecBlockRef))
+        || file.read((uint8_t *)refs, sizeof(refs)) != sizeof(refs)) {
+        return false;
+    }
+
+    size_t len = refs[1].offset - refs[0].offset;
+    if (refs[1].offset < refs[0].offset || len > sizeof(cache->data)) return false;
+    if (!file.seek(refs[0].offset) || file.read(cache->data, len) != len) return false;
+
+    uint32_t first = block * SENSOR_CODEC_BLOCK_RECORDS;
+    size_t count = header.count - first < SENSOR_CODEC_BLOCK_RECORDS ? header.count - first : SENSOR_CODEC_BLOCK_RECORDS;
+    if (!sensorCodecDecode(cache->state, cache->data, len, cache->records, count)) return false;
+
+    strncpy(cache->path, path, sizeof(cache->path) - 1);
+    cache->path[sizeof(cache->path) - 1] = '\0';
+    cache->block = block;
+    cache->count = count;
+    return true;
+}
+
+size_t sensorCodecRead(fs::FS &fs, const char *path, uint32_t first, SensorRecord *records, size_t maxRecords) {
+    if (!cache || maxRecords == 0) return 0;
+    MetricsScope scope(METRIC_SD_READ);
+
+    xSemaphoreTake(cacheLock, portMAX_DELAY);
+
+    // Geöffnet wird erst, wenn ein Block nicht im Puffer liegt
+    File file;
+    SensorCodecHeader header;
+    bool opened = false;
+    size_t count = 0;
+
+    while (count < maxRecords) {
+        uint32_t index = first + count;
+        uint32_t block = index / SENSOR_CODEC_BLOCK_RECORDS;
+
+        bool cached = cache->block == block && strcmp(cache->path, path) == 0;
+        if (!cached) {
+            if (!opened) {
+                file = fs.open(path, FILE_READ);
+                opened = true;
+                if (!file || !readHeader(file, header)) break;
+            }
+            if (index >= header.count || !loadBlock(file, header, path, block)) break;
+        }
+
+        uint32_t offset = index - block * SENSOR_CODEC_BLOCK_RECORDS;
+        if (offset >= cache->count) break;
+
+        size_t n = cache->count - offset;
+        if (n > maxRecords - count) n = maxRecords - count;
+        memcpy(records + count, cache->records + offset, n * sizeof(SensorRecord));
+        count += n;
+    }
+
+    if (file) file.close();
+    xSemaphoreGive(cacheLock);
+    return count;
+}
+
+uint32_t sensorCodecLowerBound(fs::FS &fs, const char *path, uint32_t t) {
+    if (!cache) return 0;
+    MetricsScope scope(METRIC_SD_READ);
+
+    File file = fs.open(path, FILE_READ);
+    SensorCodecHeader header;
+    if (!file || !readHeader(file, header)) return 0;
+
+    // Erster Block, der bei t oder später beginnt; gesucht wird im Block davor
+    uint32_t low = 0;
+    uint32_t high = header.blockCount;
+    SensorCodecBlockRef ref;
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if (!readRef(file, mid, ref)) {
+            file.close();
+            return 0;
+        }
+        if (ref.firstTimestamp < t) low = mid + 1;
+        else high = mid;
+    }
+
+    uint32_t result = low * SENSOR_CODEC_BLOCK_RECORDS;
+    if (low > 0) {
+        xSemaphoreTake(cacheLock, portMAX_DELAY);
+        uint32_t block = low - 1;
+        if (loadBlock(file, header, path, block)) {
+            size_t i = 0;
+            while (i < cache->count && cache->records[i].timestamp < t) i++;
+            result = block * SENSOR_CODEC_BLOCK_RECORDS + i;
+        }
+        xSemaphoreGive(cacheLock);
+    }
+
+    file.close();
+    return result < header.count ? result : header.count;
+}
+
+bool sensorCodecCompress(fs::FS &fs, const char *rawPath, uint32_t count, const char *path) {
+    uint32_t blockCount = (count + SENSOR_CODEC_BLOCK_RECORDS - 1) / SENSOR_CODEC_BLOCK_RECORDS;
+    size_t refsSize = (blockCount + 1) * sizeof(SensorCodecBlockRef);
+
+    EncodeWorkspace *work = (EncodeWorkspace *)(psramFound() ? ps_malloc(sizeof(EncodeWorkspace)) : malloc(sizeof(EncodeWorkspace)));
+    SensorCodecBlockRef *refs = (SensorCodecBlockRef *)malloc(refsSize);
+    if (!work || !refs) {
+        free(work);
+        free(refs);
+        return false;
+    }
+
+    // Erst als .tmp, die fertige Datei ist immer vollständig
+    char tmpPath[RECORD_FILE_PATH_MAX];
+    snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", path);
+
+    SensorCodecHeader header = { SENSOR_CODEC_MAGIC, SENSOR_CODEC_VERSION, SENSOR_CODEC_BLOCK_RECORDS, count, blockCount };
+    memset(refs, 0, refsSize);
+
+    File out = fs.open(tmpPath, FILE_WRITE);
+    bool ok = out
+           && out.write((const uint8_t *)&header, sizeof(header)) == sizeof(header)
+           && out.write((const uint8_t *)refs, refsSize) == refsSize;
+
+    uint32_t offset = sizeof(header) + refsSize;
+    for (uint32_t block = 0; ok && block < blockCount; block++) {
+        uint32_t first = block * SENSOR_CODEC_BLOCK_RECORDS;
+        size_t wanted = count - first < SENSOR_CODEC_BLOCK_RECORDS ? count - first : SENSOR_CODEC_BLOCK_RECORDS;
+
+        ok = RecordFile::read(fs, rawPath, sizeof(SensorRecord), count, first, work->records, wanted) == wanted;
+        size_t len = ok ? sensorCodecEncode(work->state, work->records, wanted, work->data, sizeof(work->data)) : 0;
+        ok = len > 0 && out.write(work->data, len) == len;
+
+        refs[block].offset = offset;
+        refs[block].firstTimestamp = work->records[0].timestamp;
+        offset += len;
+    }
+    refs[blockCount].offset = offset;
+
+    // Blocktabelle steht erst jetzt fest
+    ok = ok && out.seek(sizeof(header)) && out.write((const uint8_t *)refs, refsSize) == refsSize;
+    if (out) out.close();
+
+    free(work);
+    free(refs);
+
+    if (!ok) {
+        fs.remove(tmpPath);
+        return false;
+    }
+
+    // Ein alter Stand unter diesem Namen darf nicht mehr aus dem Puffer kommen
+    xSemaphoreTake(cacheLock, portMAX_DELAY);
+    if (strcmp(cache->path, path) == 0) cache->path[0] = '\0';
+    xSemaphoreGive(cacheLock);
+
+    fs.remove(path);
+    return fs.rename(tmpPath, path);
+}
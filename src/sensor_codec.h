@@ -0,0 +1,89 @@
+// sensor_codec.h - Komprimierte Log-Partitionen (Gorilla-artig)
+//
+// Abgeschlossene Tage des Logs (siehe sensor_log.h) werden vom storage-Task
+// aus der RecordFile (32 Byte je Satz) in dieses Format umgeschrieben:
+//
+//   SensorCodecHeader       16 Byte
+//   SensorCodecBlockRef     je Block Offset + Zeitstempel des ersten Satzes,
+//                           dazu ein Abschluss-Eintrag mit dem Dateiende
+//   Blöcke                  je SENSOR_CODEC_BLOCK_RECORDS Sätze als Bitstrom
+//
+// Jeder Block lässt sich für sich decodieren, Lesen per Index kostet also
+// einen Block statt der ganzen Datei; die Zeitstempel in der Blocktabelle
+// erlauben die binäre Suche ohne Decodieren.
+//
+// Im Block, pro Satz (Bits, höchstwertiges zuerst):
+//   Zeitstempel   Delta-of-Delta zum Vorgänger (zigzag):
+//                 0 | 10+7 | 110+9 | 1110+12 | 1111+32 (erster Satz: 32 Bit roh)
+//   Node          5 Bit
+//   valid         0 = wie beim letzten Satz des Nodes | 1+8
+//   reserved      0 = 0 | 1+16
+//   Werte         nur gültige Slots: Differenz zum letzten Wert desselben
+//                 Nodes und Slots, in 1/SENSOR_CODEC_SCALE (zigzag):
+//                 0 | 10+4 | 110+8 | 1110+16 | 11110+32 | 11111+32 Bit float roh
+//
+// Werte werden dabei auf 0,01 gerundet (so gibt /sd-data sie ohnehin aus),
+// nicht gültige Slots kommen als 0 zurück. Typische Sätze brauchen 3-6 Byte.
+#ifndef SENSOR_CODEC_H
+#define SENSOR_CODEC_H
+
+#include <Arduino.h>
+#include "FS.h"
+#include "sensor_log.h"
+#include "node_registry.h"
+
+#define SENSOR_CODEC_MAGIC          0x43534C48UL    // "HLSC"
+#define SENSOR_CODEC_VERSION        1
+#define SENSOR_CODEC_BLOCK_RECORDS  64
+#define SENSOR_CODEC_SCALE          100.0           // Auflösung der Werte: 0,01
+
+// Obergrenze für einen Block: 36 + 5 + 9 + 17 + 6 * 37 Bit je Satz
+#define SENSOR_CODEC_MAX_BLOCK_BYTES (SENSOR_CODEC_BLOCK_RECORDS * 37)
+
+struct SensorCodecHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t blockRecords;
+    uint32_t count;             // Sätze in der Datei
+    uint32_t blockCount;
+};
+
+struct SensorCodecBlockRef {
+    uint32_t offset;            // ab Dateianfang
+    uint32_t firstTimestamp;
+};
+
+static_assert(sizeof(SensorCodecHeader) == 16, "SensorCodecHeader muss 16 Byte haben");
+
+// Zustand während eines Blocks: letzter Zeitstempel und je Node der letzte
+// valid-Wert und die letzten Werte. Groß genug, um nicht auf den Stack zu gehören.
+struct SensorCodecState {
+    uint32_t timestamp;
+    uint32_t delta;
+    bool seen[NODE_MAX];
+    uint8_t valid[NODE_MAX];
+    int32_t values[NODE_MAX][SENSOR_LOG_VALUES];
+};
+
+// Legt den Puffer für decodierte Blöcke an. Vor dem ersten Lesen aufrufen.
+bool sensorCodecBegin();
+
+// Einen Block codieren; gibt die Länge in Byte zurück, 0 bei zu wenig Platz
+// oder einem Satz, der sich nicht darstellen lässt (Node >= NODE_MAX)
+size_t sensorCodecEncode(SensorCodecState &state, const SensorRecord *records, size_t count,
+                         uint8_t *out, size_t maxLen);
+
+// count Sätze aus einem Block decodieren, false bei kaputten Daten
+bool sensorCodecDecode(SensorCodecState &state, const uint8_t *data, size_t len,
+                       SensorRecord *records, size_t count);
+
+// Schreibt die Partition rawPath (RecordFile mit count Sätzen) komprimiert
+// nach path. Nur aus dem storage-Task.
+bool sensorCodecCompress(fs::FS &fs, const char *rawPath, uint32_t count, const char *path);
+
+// Wie RecordFile::read() bzw. lowerBound(); der zuletzt decodierte Block
+// bleibt im RAM, fortlaufendes Lesen decodiert jeden Block nur einmal
+size_t sensorCodecRead(fs::FS &fs, const char *path, uint32_t first, SensorRecord *records, size_t maxRecords);
+uint32_t sensorCodecLowerBound(fs::FS &fs, const char *path, uint32_t t);
+
+#endif
@@ -0,0 +1,1249 @@
+#include "sensor_log.h"
+#include "sensor_codec.h"
+#include "metrics.h"
+#include <time.h>
+
+#define SENSOR_LOG_TMP_FILE     SENSOR_LOG_FILE ".tmp"
+#define SENSOR_LOG_V1_BACKUP    "/sensor_log.v1.bak"
+#define SENSOR_LOG_V2_BACKUP    "/sensor_log.v2.bak"
+#define MANIFEST_TMP_FILE       SENSOR_LOG_MANIFEST_FILE ".tmp"
+#define BACKFILL_TMP_FILE       SENSOR_LOG_BACKFILL_FILE ".tmp"
+#define MERGE_TMP_FILE          SENSOR_LOG_DIR "/merge.tmp"
+#define MANIFEST_MIN_CAPACITY   64
+
+// Format v1: feste Spalten ESP32 T/H/P, Pico T/H/P
+#define LEGACY_COLUMNS 6
+
+struct LegacyRecord {
+    uint32_t timestamp;
+    float values[LEGACY_COLUMNS];
+};
+
+enum PartitionFormat : uint32_t {
+    PARTITION_RAW = 0,          // RecordFile, DD.bin
+    PARTITION_COMPRESSED,       // sensor_codec.h, DD.blk
+};
+
+// Eintrag im Manifest, einer je Partition. Die ersten 4 Byte sind wie bei
+// jeder RecordFile ein Zeitstempel.
+struct PartitionEntry {
+    uint32_t first;         // Zeitstempel des ersten Satzes, bestimmt auch den Dateinamen
+    uint32_t last;          // Zeitstempel des letzten Satzes
+    uint32_t firstIndex;    // Log-Index des ersten Satzes
+    uint32_t count;
+    uint32_t format;        // PartitionFormat
+};
+
+static_assert(sizeof(PartitionEntry) == 20, "PartitionEntry muss 20 Byte haben");
+
+// Manifest v1 (ohne format, alle Partitionen roh)
+#define MANIFEST_V1_RECORD_SIZE 16
+
+static RecordFile manifestFile(SENSOR_LOG_MANIFEST_FILE, SENSOR_LOG_MANIFEST_MAGIC, SENSOR_LOG_MANIFEST_VERSION,
+                               sizeof(PartitionEntry), 0);
+
+// Die jüngste Partition, nur in sie wird angehängt
+static RecordFile current("", SENSOR_LOG_MAGIC, SENSOR_LOG_VERSION, sizeof(SensorRecord), SENSOR_LOG_VALUES);
+
+#define JOURNAL_MAGIC 0x4C4E4A48UL      // "HJNL"
+
+// Journal: dieser Kopf + der Block, der gerade geschrieben wird.
+// count == 0 heißt: nichts offen.
+struct JournalHeader {
+    uint32_t magic;
+    uint32_t index;         // Log-Index des ersten Satzes
+    uint32_t count;
+    uint32_t crc;           // CRC-32 über die Sätze
+};
+
+static fs::FS *logFs = nullptr;
+static bool logReady = false;
+static uint32_t logRevision = 0;        // steht im Header des Manifests
+static File journal;
+
+// Manifest im RAM, nach Zeit und Index aufsteigend. Geändert wird nur aus
+// dem storage-Task (bzw. beim Start), gelesen auch aus dem AsyncTCP-Task:
+// Leser kopieren einzelne Einträge unter logMux.
+static PartitionEntry *partitions = nullptr;
+static uint32_t partitionCount = 0;
+static uint32_t partitionCapacity = 0;
+
+// Noch nicht geschriebene Sätze, sie folgen direkt auf die Partitionen
+static SensorRecord pending[SENSOR_LOG_BATCH_RECORDS];
+static uint32_t pendingCount = 0;
+static uint32_t durableCount = 0;       // Log-Index hinter dem letzten geschriebenen Satz
+static portMUX_TYPE logMux = portMUX_INITIALIZER_UNLOCKED;
+
+// Nachlieferungen, die noch einsortiert werden: erst im RAM, dann in
+// Ankunftsreihenfolge in SENSOR_LOG_BACKFILL_FILE. Nur der storage-Task.
+static RecordFile backfillFile(SENSOR_LOG_BACKFILL_FILE, SENSOR_LOG_MAGIC, SENSOR_LOG_VERSION,
+                               sizeof(SensorRecord), SENSOR_LOG_VALUES);
+static SensorRecord backfillPending[SENSOR_LOG_BATCH_RECORDS];
+static uint32_t backfillPendingCount = 0;
+
+// Arbeitsspeicher für sensorLogMerge(), nur während des Einsortierens angelegt
+struct MergeWorkspace {
+    SensorRecord batch[SENSOR_LOG_MERGE_RECORDS];
+    bool duplicate[SENSOR_LOG_MERGE_RECORDS];   // batch[i] stand schon im Log
+    SensorRecord in[SENSOR_LOG_BATCH_RECORDS];
+    SensorRecord out[SENSOR_LOG_BATCH_RECORDS];
+};
+
+static uint32_t crc32(const void *data, size_t len) {
+    const uint8_t *bytes = (const uint8_t *)data;
+    uint32_t crc = 0xFFFFFFFFUL;
+
+    for (size_t i = 0; i < len; i++) {
+        crc ^= bytes[i];
+        for (int bit = 0; bit < 8; bit++) crc = (crc >> 1) ^ (0xEDB88320UL & (0 - (crc & 1)));
+    }
+    return ~crc;
+}
+
+static uint32_t dayOf(uint32_t timestamp) {
+    return timestamp / SENSOR_LOG_PARTITION_SECONDS;
+}
+
+// "/log/2026/10/18.bin" für den UTC-Tag von timestamp; ohne extension nur das Verzeichnis
+static void partitionPath(uint32_t timestamp, char *path, size_t len, const char *extension = ".bin") {
+    time_t t = timestamp;
+    struct tm timeinfo;
+    gmtime_r(&t, &timeinfo);
+
+    if (extension) {
+        snprintf(path, len, SENSOR_LOG_DIR "/%04d/%02d/%02d%s",
+                 timeinfo.tm_year + 1900, timeinfo.tm_mon + 1, timeinfo.tm_mday, extension);
+    } else {
+        snprintf(path, len, SENSOR_LOG_DIR "/%04d/%02d", timeinfo.tm_year + 1900, timeinfo.tm_mon + 1);
+    }
+}
+
+static void partitionPath(const PartitionEntry &entry, char *path, size_t len) {
+    partitionPath(entry.first, path, len, entry.format == PARTITION_COMPRESSED ? ".blk" : ".bin");
+}
+
+// tmp ersetzt path. Bricht es zwischen den beiden rename() ab, holt
+// recoverFile() beim nächsten Start den alten Stand zurück.
+static bool replaceFile(const char *tmp, const char *path) {
+    char oldPath[RECORD_FILE_PATH_MAX + 4];
+    snprintf(oldPath, sizeof(oldPath), "%s.old", path);
+
+    logFs->remove(oldPath);
+    if (!logFs->rename(path, oldPath)) return false;
+    if (!logFs->rename(tmp, path)) {
+        logFs->rename(oldPath, path);
+        return false;
+    }
+    logFs->remove(oldPath);
+    return true;
+}
+
+static void recoverFile(const char *path) {
+    char oldPath[RECORD_FILE_PATH_MAX + 4];
+    snprintf(oldPath, sizeof(oldPath), "%s.old", path);
+
+    if (!logFs->exists(oldPath)) return;
+    if (logFs->exists(path)) logFs->remove(oldPath);
+    else logFs->rename(oldPath, path);
+}
+
+static void makeDir(const char *path) {
+    if (!logFs->exists(path)) logFs->mkdir(path);
+}
+
+static void makePartitionDirs(uint32_t timestamp) {
+    char path[RECORD_FILE_PATH_MAX];
+    partitionPath(timestamp, path, sizeof(path), nullptr);
+
+    // "/log/2026/10": erst "/log/2026", dann der Monat
+    path[strlen(SENSOR_LOG_DIR) + 5] = '\0';
+    makeDir(path);
+    partitionPath(timestamp, path, sizeof(path), nullptr);
+    makeDir(path);
+}
+
+// Leere Monats- und Jahresverzeichnisse entfernen; rmdir() scheitert, solange noch etwas darin liegt
+static void removePartitionDirs(uint32_t timestamp) {
+    char path[RECORD_FILE_PATH_MAX];
+    partitionPath(timestamp, path, sizeof(path), nullptr);
+    logFs->rmdir(path);
+    path[strlen(SENSOR_LOG_DIR) + 5] = '\0';
+    logFs->rmdir(path);
+}
+
+// Platz für needed Einträge. Das neue Feld wird außerhalb des Locks angelegt
+// und nur getauscht, Leser halten nie einen Zeiger hinein.
+static bool reservePartitions(uint32_t needed) {
+    if (needed <= partitionCapacity) return true;
+
+    uint32_t capacity = partitionCapacity ? partitionCapacity : MANIFEST_MIN_CAPACITY;
+    while (capacity < needed) capacity *= 2;
+
+    size_t size = capacity * sizeof(PartitionEntry);
+    PartitionEntry *grown = (PartitionEntry *)(psramFound() ? ps_malloc(size) : malloc(size));
+    if (!grown) {
+        Serial.println("Kein Speicher für das Log-Manifest!");
+        return false;
+    }
+
+    portENTER_CRITICAL(&logMux);
+    if (partitionCount) memcpy(grown, partitions, partitionCount * sizeof(PartitionEntry));
+    PartitionEntry *old = partitions;
+    partitions = grown;
+    partitionCapacity = capacity;
+    portEXIT_CRITICAL(&logMux);
+
+    free(old);
+    return true;
+}
+
+// Letzte Partition mit firstIndex <= index, -1 wenn keine. Nur unter logMux
+// oder aus dem storage-Task.
+static int findByIndex(uint32_t index) {
+    uint32_t low = 0;
+    uint32_t high = partitionCount;
+
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if (partitions[mid].firstIndex <= index) low = mid + 1;
+        else high = mid;
+    }
+    return (int)low - 1;
+}
+
+// Erste Partition, deren letzter Satz nicht vor t liegt; partitionCount wenn keine
+static uint32_t findByTime(uint32_t t) {
+    uint32_t low = 0;
+    uint32_t high = partitionCount;
+
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if (partitions[mid].last < t) low = mid + 1;
+        else high = mid;
+    }
+    return low;
+}
+
+// Log-Index hinter dem letzten Satz der jüngsten Partition
+static uint32_t partitionsEnd() {
+    if (partitionCount == 0) return durableCount;
+    const PartitionEntry &last = partitions[partitionCount - 1];
+    return last.firstIndex + last.count;
+}
+
+// Legt die Partition für den Tag von timestamp an, ihr erster Satz bekommt
+// den Log-Index index. Die bisherige jüngste wird im Manifest abgeschlossen.
+static bool openPartition(uint32_t timestamp, uint32_t index) {
+    if (!reservePartitions(partitionCount + 1)) return false;
+
+    if (partitionCount > 0 && !manifestFile.write(partitionCount - 1, &partitions[partitionCount - 1])) {
+        return false;
+    }
+
+    // Erst ins Manifest, dann die Datei: so findet der nächste Start jede Datei wieder
+    PartitionEntry entry = { timestamp, timestamp, index, 0, PARTITION_RAW };
+    if (!manifestFile.write(partitionCount, &entry)) return false;
+
+    char path[RECORD_FILE_PATH_MAX];
+    partitionPath(timestamp, path, sizeof(path));
+    makePartitionDirs(timestamp);
+
+    current.setPath(path);
+    if (!RecordFile::create(*logFs, path, SENSOR_LOG_MAGIC, SENSOR_LOG_VERSION, sizeof(SensorRecord), SENSOR_LOG_VALUES)
+        || !current.begin(*logFs)) {
+        Serial.printf("Fehler beim Anlegen von %s!\n", path);
+        return false;
+    }
+
+    portENTER_CRITICAL(&logMux);
+    partitions[partitionCount++] = entry;
+    portEXIT_CRITICAL(&logMux);
+    return true;
+}
+
+// Schreibt count Sätze ab Log-Index index in die Partition, die ihn enthält.
+// Am Ende der jüngsten Partition beginnt ein neuer Tag eine neue; ältere
+// Partitionen werden nur beim Nachschreiben aus dem Journal berührt.
+static bool writeRecords(uint32_t index, const SensorRecord *records, size_t count) {
+    int slot = findByIndex(index);
+    bool newest = slot >= 0 && (uint32_t)slot == partitionCount - 1;
+
+    // Vor der ältesten Partition (schon gelöscht) wird nichts mehr geschrieben
+    if (slot < 0 && partitionCount > 0) return false;
+
+    if (slot < 0 || (newest && index == partitionsEnd() && partitions[slot].count > 0
+                     && dayOf(records[0].timestamp) > dayOf(partitions[slot].first))) {
+        if (!openPartition(records[0].timestamp, index)) return false;
+        slot = partitionCount - 1;
+        newest = true;
+    }
+
+    PartitionEntry entry = partitions[slot];
+    uint32_t local = index - entry.firstIndex;
+    bool ok;
+
+    if (newest) {
+        ok = current.write(local, records, count);
+    } else if (entry.format == PARTITION_COMPRESSED) {
+        Serial.println("Partition ist schon komprimiert, Nachschreiben nicht möglich!");
+        return false;
+    } else {
+        char path[RECORD_FILE_PATH_MAX];
+        partitionPath(entry, path, sizeof(path));
+        RecordFile older(path, SENSOR_LOG_MAGIC, SENSOR_LOG_VERSION, sizeof(SensorRecord), SENSOR_LOG_VALUES);
+        ok = older.begin(*logFs) && older.write(local, records, count);
+    }
+    if (!ok) return false;
+
+    portENTER_CRITICAL(&logMux);
+    PartitionEntry &updated = partitions[slot];
+    if (local + count > updated.count) updated.count = local + count;
+    if (records[count - 1].timestamp > updated.last) updated.last = records[count - 1].timestamp;
+    portEXIT_CRITICAL(&logMux);
+    return true;
+}
+
+// Block ab Log-Index index, an Tagesgrenzen auf die Partitionen verteilt
+static bool writeBlock(uint32_t index, const SensorRecord *records, size_t count) {
+    size_t start = 0;
+
+    while (start < count) {
+        size_t end = start + 1;
+        while (end < count && dayOf(records[end].timestamp) == dayOf(records[start].timestamp)) end++;
+
+        if (!writeRecords(index + start, records + start, end - start)) return false;
+        start = end;
+    }
+    return true;
+}
+
+// Ganzes Manifest neu schreiben (nach dem Löschen alter Partitionen und dem
+// Einsortieren), mit logRevision im Header
+static bool saveManifest(const PartitionEntry *entries, uint32_t count) {
+    if (!RecordFile::create(*logFs, MANIFEST_TMP_FILE, SENSOR_LOG_MANIFEST_MAGIC, SENSOR_LOG_MANIFEST_VERSION,
+                            sizeof(PartitionEntry), 0, logRevision)) {
+        return false;
+    }
+
+    File out = logFs->open(MANIFEST_TMP_FILE, FILE_APPEND);
+    if (!out) return false;
+    size_t len = count * sizeof(PartitionEntry);
+    bool ok = len == 0 || out.write((const uint8_t *)entries, len) == len;
+    out.close();
+    if (!ok) return false;
+
+    manifestFile.close();
+    logFs->remove(SENSOR_LOG_MANIFEST_FILE);
+    logFs->rename(MANIFEST_TMP_FILE, SENSOR_LOG_MANIFEST_FILE);
+    return manifestFile.begin(*logFs);
+}
+
+// Manifest v1 (ohne format, alle Partitionen roh) auf v2 umschreiben
+static bool upgradeManifest() {
+    RecordFile old(SENSOR_LOG_MANIFEST_FILE, SENSOR_LOG_MANIFEST_MAGIC, 1, MANIFEST_V1_RECORD_SIZE, 0);
+    if (!logFs->exists(SENSOR_LOG_MANIFEST_FILE) || !old.begin(*logFs)) return false;
+
+    uint32_t count = old.count();
+    if (!reservePartitions(count)) return false;
+
+    for (uint32_t i = 0; i < count; i++) {
+        PartitionEntry entry;
+        memset(&entry, 0, sizeof(entry));
+        if (old.read(i, &entry, 1) != 1) return false;
+        entry.format = PARTITION_RAW;
+        partitions[i] = entry;
+    }
+    old.close();
+
+    Serial.printf("Log-Manifest auf v%d umgestellt: %lu Partitionen\n",
+                  SENSOR_LOG_MANIFEST_VERSION, (unsigned long)count);
+    return saveManifest(partitions, count);
+}
+
+static bool loadManifest() {
+    if (!manifestFile.begin(*logFs) && !(upgradeManifest() && manifestFile.begin(*logFs))) return false;
+
+    uint32_t count = manifestFile.count();
+    if (!reservePartitions(count)) return false;
+
+    uint32_t loaded = 0;
+    while (loaded < count) {
+        size_t read = manifestFile.read(loaded, partitions + loaded, count - loaded);
+        if (read == 0) break;
+        loaded += read;
+    }
+
+    portENTER_CRITICAL(&logMux);
+    partitionCount = loaded;
+    portEXIT_CRITICAL(&logMux);
+    return loaded == count;
+}
+
+// Die jüngste Partition öffnen. Ihr Stand im Manifest wird erst beim
+// Tageswechsel geschrieben, maßgeblich ist deshalb die Datei selbst.
+static bool openNewestPartition() {
+    if (partitionCount == 0) return true;
+
+    PartitionEntry &newest = partitions[partitionCount - 1];
+    char path[RECORD_FILE_PATH_MAX];
+    partitionPath(newest.first, path, sizeof(path));
+    makePartitionDirs(newest.first);
+    recoverFile(path);
+
+    current.setPath(path);
+    if (!current.begin(*logFs)) return false;
+
+    SensorRecord record;
+    uint32_t count = current.count();
+    uint32_t last = newest.first;
+    if (count > 0 && current.read(count - 1, &record, 1) == 1) last = record.timestamp;
+
+    portENTER_CRITICAL(&logMux);
+    newest.count = count;
+    newest.last = last;
+    portEXIT_CRITICAL(&logMux);
+    return true;
+}
+
+// Einmalig: /sensor_log.bin (ein Log für alles) auf Tages-Partitionen
+// verteilen. Das Manifest entsteht als .tmp und ersetzt erst am Ende ein
+// altes; nach einem Abbruch wird beim nächsten Start neu aufgeteilt.
+static bool splitSingleLog(fs::FS &fs) {
+    RecordFile single(SENSOR_LOG_FILE, SENSOR_LOG_MAGIC, SENSOR_LOG_VERSION, sizeof(SensorRecord), SENSOR_LOG_VALUES);
+    if (!single.begin(fs)) return false;
+
+    Serial.printf("Teile Log auf Tages-Partitionen auf: %lu Datensätze...\n", (unsigned long)single.count());
+
+    manifestFile.setPath(MANIFEST_TMP_FILE);
+    bool ok = RecordFile::create(fs, MANIFEST_TMP_FILE, SENSOR_LOG_MANIFEST_MAGIC, SENSOR_LOG_MANIFEST_VERSION,
+                                 sizeof(PartitionEntry), 0)
+           && manifestFile.begin(fs);
+
+    portENTER_CRITICAL(&logMux);
+    partitionCount = 0;
+    portEXIT_CRITICAL(&logMux);
+
+    SensorRecord block[SENSOR_LOG_BATCH_RECORDS];
+    uint32_t index = 0;
+    while (ok && index < single.count()) {
+        size_t count = single.read(index, block, SENSOR_LOG_BATCH_RECORDS);
+        if (count == 0) break;
+        ok = writeBlock(index, block, count);
+        index += count;
+    }
+
+    // Die letzte Partition ist hier schon vollständig
+    if (ok && partitionCount > 0) ok = manifestFile.write(partitionCount - 1, &partitions[partitionCount - 1]);
+
+    manifestFile.close();
+    current.close();
+    manifestFile.setPath(SENSOR_LOG_MANIFEST_FILE);
+
+    if (!ok) {
+        Serial.println("Fehler beim Aufteilen des Logs!");
+        return false;
+    }
+
+    fs.remove(SENSOR_LOG_MANIFEST_FILE);
+    fs.rename(MANIFEST_TMP_FILE, SENSOR_LOG_MANIFEST_FILE);
+    fs.rename(SENSOR_LOG_FILE, SENSOR_LOG_V2_BACKUP);
+
+    Serial.printf("Log aufgeteilt: %lu Partitionen\n", (unsigned long)partitionCount);
+    return true;
+}
+
+static bool writeJournal(const JournalHeader &header, const SensorRecord *records) {
+    MetricsScope scope(METRIC_SD_WRITE);
+
+    if (!journal) journal = logFs->open(SENSOR_LOG_JOURNAL_FILE, "r+");
+    if (!journal) return false;
+
+    size_t len = header.count * sizeof(SensorRecord);
+    bool ok = journal.seek(0)
+           && journal.write((const uint8_t *)&header, sizeof(header)) == sizeof(header)
+           && (len == 0 || journal.write((const uint8_t *)records, len) == len);
+    journal.flush();
+    return ok;
+}
+
+static bool clearJournal() {
+    JournalHeader header = { JOURNAL_MAGIC, 0, 0, 0 };
+    return writeJournal(header, nullptr);
+}
+
+// Offenen Block aus dem Journal nachschreiben (Abbruch beim letzten Schreiben)
+static void replayJournal(fs::FS &fs) {
+    if (!fs.exists(SENSOR_LOG_JOURNAL_FILE)) {
+        File file = fs.open(SENSOR_LOG_JOURNAL_FILE, FILE_WRITE);
+        file.close();
+        clearJournal();
+        return;
+    }
+
+    JournalHeader header;
+    SensorRecord records[SENSOR_LOG_BATCH_RECORDS];
+
+    File file = fs.open(SENSOR_LOG_JOURNAL_FILE, FILE_READ);
+    bool ok = file && file.read((uint8_t *)&header, sizeof(header)) == sizeof(header)
+           && header.magic == JOURNAL_MAGIC
+           && header.count > 0 && header.count <= SENSOR_LOG_BATCH_RECORDS
+           && file.read((uint8_t *)records, header.count * sizeof(SensorRecord)) == header.count * sizeof(SensorRecord)
+           && crc32(records, header.count * sizeof(SensorRecord)) == header.crc;
+    if (file) file.close();
+
+    // Nur direkt ans Ende bzw. über den abgebrochenen Block, nie mitten ins Log
+    if (ok && header.index <= partitionsEnd()) {
+        if (writeBlock(header.index, records, header.count)) {
+            Serial.printf("Journal: %lu Datensätze ab %lu nachgeschrieben\n",
+                          (unsigned long)header.count, (unsigned long)header.index);
+        }
+    }
+
+    clearJournal();
+}
+
+bool sensorLogBegin(fs::FS &fs) {
+    if (journal) journal.close();
+    current.close();
+    manifestFile.close();
+    backfillFile.close();
+    logReady = false;
+    pendingCount = 0;
+    durableCount = 0;
+    backfillPendingCount = 0;
+    logRevision = 0;
+
+    portENTER_CRITICAL(&logMux);
+    partitionCount = 0;
+    portEXIT_CRITICAL(&logMux);
+
+    logFs = &fs;
+    makeDir(SENSOR_LOG_DIR);
+    if (!sensorCodecBegin()) return false;
+
+    if (fs.exists(SENSOR_LOG_FILE) && !splitSingleLog(fs)) return false;
+    if (!loadManifest() || !openNewestPartition()) {
+        Serial.println("Log-Manifest bzw. jüngste Partition nicht lesbar!");
+        return false;
+    }
+
+    logRevision = manifestFile.reserved();
+    replayJournal(fs);
+
+    recoverFile(SENSOR_LOG_BACKFILL_FILE);
+    if (!backfillFile.begin(fs)) {
+        fs.remove(SENSOR_LOG_BACKFILL_FILE);
+        if (!backfillFile.begin(fs)) Serial.println("Nachlieferungen sind nicht möglich!");
+    }
+
+    portENTER_CRITICAL(&logMux);
+    durableCount = partitionsEnd();
+    portEXIT_CRITICAL(&logMux);
+    logReady = true;
+
+    Serial.printf("Binär-Log: %lu Datensätze in %lu Partitionen, %lu Nachlieferungen offen\n",
+                  (unsigned long)(durableCount - sensorLogFirstIndex()), (unsigned long)partitionCount,
+                  (unsigned long)backfillFile.count());
+    return true;
+}
+
+bool sensorLogReady() {
+    return logReady;
+}
+
+bool sensorLogAppend(const SensorRecord &record) {
+    if (!logReady) return false;
+
+    // Letztes Schreiben ist gescheitert und der Block liegt noch voll im RAM
+    if (pendingCount == SENSOR_LOG_BATCH_RECORDS && !sensorLogFlush()) return false;
+
+    portENTER_CRITICAL(&logMux);
+    pending[pendingCount++] = record;
+    bool full = pendingCount == SENSOR_LOG_BATCH_RECORDS;
+    portEXIT_CRITICAL(&logMux);
+
+    if (full) sensorLogFlush();
+    return true;
+}
+
+static bool flushBackfill() {
+    if (backfillPendingCount == 0) return true;
+
+    if (!backfillFile.append(backfillPending, backfillPendingCount)) {
+        Serial.println("Fehler beim Schreiben der Nachlieferungen!");
+        return false;
+    }
+    backfillPendingCount = 0;
+    return true;
+}
+
+bool sensorLogFlush() {
+    flushBackfill();
+
+    // Nur der storage-Task ändert pending, lesen ohne Lock ist hier sicher
+    if (pendingCount == 0) return true;
+
+    JournalHeader header = { JOURNAL_MAGIC, durableCount, pendingCount, crc32(pending, pendingCount * sizeof(SensorRecord)) };
+
+    if (!writeJournal(header, pending)) {
+        Serial.println("Fehler beim Schreiben des Journals!");
+    }
+
+    // Bei einem Fehler bleibt der Block im RAM und wird beim nächsten Mal wiederholt
+    if (!writeBlock(durableCount, pending, pendingCount)) {
+        Serial.println("Fehler beim Schreiben ins Log!");
+        return false;
+    }
+
+    portENTER_CRITICAL(&logMux);
+    durableCount = partitionsEnd();
+    pendingCount = 0;
+    portEXIT_CRITICAL(&logMux);
+
+    clearJournal();
+    return true;
+}
+
+bool sensorLogWritten() {
+    // Nur der storage-Task ändert beide, lesen ohne Lock ist hier sicher
+    return logReady && pendingCount == 0 && backfillPendingCount == 0;
+}
+
+uint32_t sensorLogCount() {
+    portENTER_CRITICAL(&logMux);
+    uint32_t count = durableCount + pendingCount;
+    portEXIT_CRITICAL(&logMux);
+    return count;
+}
+
+uint32_t sensorLogFirstIndex() {
+    portENTER_CRITICAL(&logMux);
+    uint32_t first = partitionCount ? partitions[0].firstIndex : durableCount;
+    portEXIT_CRITICAL(&logMux);
+    return first;
+}
+
+uint32_t sensorLogNewest() {
+    portENTER_CRITICAL(&logMux);
+    uint32_t newest = pendingCount ? pending[pendingCount - 1].timestamp
+                    : partitionCount ? partitions[partitionCount - 1].last : 0;
+    portEXIT_CRITICAL(&logMux);
+    return newest;
+}
+
+uint32_t sensorLogRevision() {
+    portENTER_CRITICAL(&logMux);
+    uint32_t revision = logRevision;
+    portEXIT_CRITICAL(&logMux);
+    return revision;
+}
+
+bool sensorLogRead(uint32_t index, SensorRecord &record) {
+    return sensorLogReadRange(index, &record, 1) == 1;
+}
+
+// Kopiert gepufferte Sätze ab Index first (>= durable); nur unter logMux
+static size_t copyPending(uint32_t first, SensorRecord *records, size_t maxRecords) {
+    size_t count = 0;
+    while (count < maxRecords && first + count < durableCount + pendingCount) {
+        records[count] = pending[first + count - durableCount];
+        count++;
+    }
+    return count;
+}
+
+// Sätze einer Partition ab local, in welchem Format auch immer
+static size_t readPartition(const PartitionEntry &entry, uint32_t local, SensorRecord *records, size_t maxRecords) {
+    char path[RECORD_FILE_PATH_MAX];
+    partitionPath(entry, path, sizeof(path));
+    return entry.format == PARTITION_COMPRESSED
+         ? sensorCodecRead(*logFs, path, local, records, maxRecords)
+         : RecordFile::read(*logFs, path, sizeof(SensorRecord), entry.count, local, records, maxRecords);
+}
+
+// Sätze ab first aus den Partitionen, nicht über limit hinaus. Geöffnet
+// werden nur die Partitionen, in denen der Bereich liegt.
+static size_t readPartitions(uint32_t first, uint32_t limit, SensorRecord *records, size_t maxRecords) {
+    size_t count = 0;
+
+    while (count < maxRecords && first + count < limit) {
+        uint32_t index = first + count;
+
+        portENTER_CRITICAL(&logMux);
+        int slot = findByIndex(index);
+        PartitionEntry entry = slot >= 0 ? partitions[slot] : PartitionEntry();
+        portEXIT_CRITICAL(&logMux);
+
+        uint32_t local = index - entry.firstIndex;
+        if (slot < 0 || local >= entry.count) break;
+
+        size_t wanted = maxRecords - count;
+        if (wanted > limit - index) wanted = limit - index;
+        if (wanted > entry.count - local) wanted = entry.count - local;
+
+        size_t read = readPartition(entry, local, records + count, wanted);
+        count += read;
+        if (read < wanted) break;
+    }
+
+    return count;
+}
+
+size_t sensorLogReadRange(uint32_t first, SensorRecord *records, size_t maxRecords) {
+    if (!logReady) return 0;
+
+    portENTER_CRITICAL(&logMux);
+    uint32_t durable = durableCount;
+    size_t count = first >= durable ? copyPending(first, records, maxRecords) : 0;
+    portEXIT_CRITICAL(&logMux);
+
+    if (first >= durable) return count;
+
+    // Erst aus den Partitionen, was dort liegt, dann aus dem Puffer
+    size_t fromFile = maxRecords < durable - first ? maxRecords : durable - first;
+    count = readPartitions(first, durable, records, fromFile);
+    if (count < fromFile || count == maxRecords) return count;
+
+    // Zwischendurch geschrieben? Dann stimmen die Puffer-Indizes nicht mehr, der Rest kommt beim nächsten Aufruf
+    portENTER_CRITICAL(&logMux);
+    if (durableCount == durable) count += copyPending(first + count, records + count, maxRecords - count);
+    portEXIT_CRITICAL(&logMux);
+
+    return count;
+}
+
+uint32_t sensorLogLowerBound(uint32_t t) {
+    if (!logReady) return 0;
+
+    portENTER_CRITICAL(&logMux);
+    uint32_t durable = durableCount;
+    uint32_t index = durable;
+    while (index < durable + pendingCount && pending[index - durable].timestamp < t) index++;
+    bool inBuffer = index > durable;
+
+    // Sonst die erste Partition, die bis t oder weiter reicht
+    uint32_t slot = findByTime(t);
+    bool found = slot < partitionCount;
+    PartitionEntry entry = found ? partitions[slot] : PartitionEntry();
+    portEXIT_CRITICAL(&logMux);
+
+    // Schon der erste gepufferte Satz ist zu alt: Antwort liegt im Puffer
+    if (inBuffer) return index;
+    if (!found) return durable;
+    if (entry.first >= t) return entry.firstIndex < durable ? entry.firstIndex : durable;
+
+    // Binäre Suche nur in dieser einen Partition
+    char path[RECORD_FILE_PATH_MAX];
+    partitionPath(entry, path, sizeof(path));
+    index = entry.firstIndex + (entry.format == PARTITION_COMPRESSED
+                                ? sensorCodecLowerBound(*logFs, path, t)
+                                : RecordFile::lowerBound(*logFs, path, sizeof(SensorRecord), entry.count, t));
+    return index < durable ? index : durable;
+}
+
+uint32_t sensorLogPrune(uint32_t before) {
+    if (!logReady) return 0;
+
+    // Ganze Partitionen, deren jüngster Satz vor before liegt; die jüngste bleibt immer
+    uint32_t drop = 0;
+    while (drop + 1 < partitionCount && partitions[drop].last < before) drop++;
+    if (drop == 0) return 0;
+
+    // Erst das Manifest ohne sie, dann die Dateien: nach einem Abbruch
+    // bleiben höchstens verwaiste Dateien, nie Verweise ins Leere
+    if (!saveManifest(partitions + drop, partitionCount - drop)) {
+        Serial.println("Fehler beim Schreiben des Log-Manifests!");
+        return 0;
+    }
+
+    uint32_t records = partitions[drop].firstIndex - partitions[0].firstIndex;
+    for (uint32_t i = 0; i < drop; i++) {
+        char path[RECORD_FILE_PATH_MAX];
+        partitionPath(partitions[i], path, sizeof(path));
+        logFs->remove(path);
+        removePartitionDirs(partitions[i].first);
+    }
+
+    portENTER_CRITICAL(&logMux);
+    memmove(partitions, partitions + drop, (partitionCount - drop) * sizeof(PartitionEntry));
+    partitionCount -= drop;
+    portEXIT_CRITICAL(&logMux);
+
+    Serial.printf("Log: %lu Partitionen mit %lu Datensätzen gelöscht\n", (unsigned long)drop, (unsigned long)records);
+    return records;
+}
+
+bool sensorLogBackfill(const SensorRecord &record) {
+    if (!logReady || !backfillFile.ready()) return false;
+
+    // Letztes Schreiben ist gescheitert und der Block liegt noch voll im RAM
+    if (backfillPendingCount == SENSOR_LOG_BATCH_RECORDS && !flushBackfill()) return false;
+    if (backfillFile.count() + backfillPendingCount >= SENSOR_LOG_BACKFILL_MAX) return false;
+
+    backfillPending[backfillPendingCount++] = record;
+    if (backfillPendingCount == SENSOR_LOG_BATCH_RECORDS) flushBackfill();
+    return true;
+}
+
+static int compareRecords(const void *a, const void *b) {
+    const SensorRecord *x = (const SensorRecord *)a;
+    const SensorRecord *y = (const SensorRecord *)b;
+
+    if (x->timestamp != y->timestamp) return x->timestamp < y->timestamp ? -1 : 1;
+    return (int)x->node - (int)y->node;
+}
+
+// Die ersten SENSOR_LOG_MERGE_RECORDS wartenden Sätze (in Ankunftsreihenfolge)
+// des ältesten Tages nach work.batch, sortiert. Gibt ihre Anzahl zurück.
+static size_t takeBackfill(MergeWorkspace &work, uint32_t &day) {
+    uint32_t total = backfillFile.count();
+    size_t taken = 0;
+    day = UINT32_MAX;
+
+    // Erst den Tag suchen, dann seine Sätze holen
+    for (int pass = 0; pass < 2; pass++) {
+        for (uint32_t index = 0; index < total && taken < SENSOR_LOG_MERGE_RECORDS;) {
+            size_t count = backfillFile.read(index, work.in, SENSOR_LOG_BATCH_RECORDS);
+            if (count == 0) return 0;
+            index += count;
+
+            for (size_t i = 0; i < count; i++) {
+                uint32_t recordDay = dayOf(work.in[i].timestamp);
+                if (pass == 0 && recordDay < day) day = recordDay;
+                if (pass == 1 && recordDay == day && taken < SENSOR_LOG_MERGE_RECORDS) work.batch[taken++] = work.in[i];
+            }
+        }
+    }
+
+    qsort(work.batch, taken, sizeof(SensorRecord), compareRecords);
+    return taken;
+}
+
+// Die Sätze aus takeBackfill() aus der Warteschlange entfernen
+static bool dropBackfill(MergeWorkspace &work, uint32_t day, size_t taken) {
+    if (!RecordFile::create(*logFs, BACKFILL_TMP_FILE, SENSOR_LOG_MAGIC, SENSOR_LOG_VERSION,
+                            sizeof(SensorRecord), SENSOR_LOG_VALUES)) {
+        return false;
+    }
+
+    File out = logFs->open(BACKFILL_TMP_FILE, FILE_APPEND);
+    bool ok = (bool)out;
+    uint32_t total = backfillFile.count();
+
+    for (uint32_t index = 0; ok && index < total;) {
+        size_t count = backfillFile.read(index, work.in, SENSOR_LOG_BATCH_RECORDS);
+        if (count == 0) ok = false;
+        index += count;
+
+        size_t kept = 0;
+        for (size_t i = 0; i < count; i++) {
+            if (taken > 0 && dayOf(work.in[i].timestamp) == day) taken--;
+            else work.out[kept++] = work.in[i];
+        }
+        ok = ok && out.write((const uint8_t *)work.out, kept * sizeof(SensorRecord)) == kept * sizeof(SensorRecord);
+    }
+    if (out) out.close();
+
+    backfillFile.close();
+    ok = ok && replaceFile(BACKFILL_TMP_FILE, SENSOR_LOG_BACKFILL_FILE);
+    if (!ok) logFs->remove(BACKFILL_TMP_FILE);
+    return backfillFile.begin(*logFs) && ok;
+}
+
+// Schreibt die Sätze von entry (nullptr = Tag ohne Partition) zusammen mit
+// work.batch sortiert nach MERGE_TMP_FILE. merged bekommt first, last und
+// count der neuen Partition, inserted die Anzahl tatsächlich eingefügter;
+// work.duplicate markiert die übrigen.
+static bool mergeInto(const PartitionEntry *entry, MergeWorkspace &work, size_t batchCount,
+                      PartitionEntry &merged, uint32_t &inserted) {
+    if (!RecordFile::create(*logFs, MERGE_TMP_FILE, SENSOR_LOG_MAGIC, SENSOR_LOG_VERSION,
+                            sizeof(SensorRecord), SENSOR_LOG_VALUES)) {
+        return false;
+    }
+
+    File out = logFs->open(MERGE_TMP_FILE, FILE_APPEND);
+    if (!out) return false;
+
+    uint32_t total = entry ? entry->count : 0;
+    uint32_t local = 0;
+    size_t inCount = 0;
+    size_t inPos = 0;
+    size_t next = 0;
+    size_t outCount = 0;
+
+    // Nodes, die zum Zeitstempel lastTimestamp schon geschrieben sind (NODE_MAX <= 32)
+    uint32_t lastTimestamp = 0;
+    uint32_t lastNodes = 0;
+
+    merged.count = 0;
+    inserted = 0;
+    bool ok = true;
+
+    while (ok) {
+        if (inPos == inCount && local < total) {
+            inCount = readPartition(*entry, local, work.in, SENSOR_LOG_BATCH_RECORDS);
+            inPos = 0;
+            if (inCount == 0) {
+                ok = false;
+                break;
+            }
+            local += inCount;
+        }
+
+        bool haveOld = inPos < inCount;
+        if (!haveOld && next == batchCount) break;
+
+        // Bei gleichem Zeitstempel zuerst die vorhandenen Sätze, ein nachgelieferter
+        // mit demselben Node ist dann schon im Log (Abbruch beim letzten Mal, doppelt gesendet)
+        bool fromBatch = next < batchCount && (!haveOld || work.batch[next].timestamp < work.in[inPos].timestamp);
+        size_t batchIndex = next;
+        SensorRecord record = fromBatch ? work.batch[next++] : work.in[inPos++];
+        uint32_t nodeBit = 1UL << (record.node % 32);
+
+        if (record.timestamp != lastTimestamp || merged.count == 0) {
+            lastTimestamp = record.timestamp;
+            lastNodes = 0;
+        }
+        if (fromBatch) work.duplicate[batchIndex] = (lastNodes & nodeBit) != 0;
+        if (fromBatch && (lastNodes & nodeBit)) continue;
+        lastNodes |= nodeBit;
+
+        if (merged.count == 0) merged.first = record.timestamp;
+        merged.last = record.timestamp;
+        merged.count++;
+        if (fromBatch) inserted++;
+
+        work.out[outCount++] = record;
+        if (outCount == SENSOR_LOG_BATCH_RECORDS) {
+            ok = out.write((const uint8_t *)work.out, sizeof(work.out)) == sizeof(work.out);
+            outCount = 0;
+        }
+    }
+
+    ok = ok && out.write((const uint8_t *)work.out, outCount * sizeof(SensorRecord)) == outCount * sizeof(SensorRecord);
+    out.close();
+    return ok;
+}
+
+// Sortiert work.batch (ein Tag) in die Partition dieses Tages ein bzw. legt
+// sie an. Die neue Datei steht unter einem anderen Namen als die alte (roh
+// <-> komprimiert), umgeschaltet wird mit dem Manifest. Nur die jüngste
+// Partition bleibt roh und wird per replaceFile() ersetzt; ihr Stand kommt
+// beim Start ohnehin aus der Datei.
+static bool mergeDay(MergeWorkspace &work, size_t batchCount, uint32_t &inserted) {
+    uint32_t day = dayOf(work.batch[0].timestamp);
+
+    // Erste Partition, die nicht vor diesem Tag liegt
+    uint32_t slot = 0;
+    uint32_t high = partitionCount;
+    while (slot < high) {
+        uint32_t mid = slot + (high - slot) / 2;
+        if (dayOf(partitions[mid].first) < day) slot = mid + 1;
+        else high = mid;
+    }
+
+    // Nach der jüngsten kann nichts nachgeliefert werden, sonst wäre es angehängt worden
+    bool exists = slot < partitionCount && dayOf(partitions[slot].first) == day;
+    if (!exists && slot == partitionCount) return false;
+
+    bool newest = exists && slot == partitionCount - 1;
+    PartitionEntry entry = exists ? partitions[slot] : PartitionEntry();
+    PartitionEntry merged = entry;
+    merged.firstIndex = partitions[slot].firstIndex;
+
+    bool ok = mergeInto(exists ? &entry : nullptr, work, batchCount, merged, inserted);
+    if (!ok || inserted == 0) {
+        logFs->remove(MERGE_TMP_FILE);
+        return ok;
+    }
+
+    // Neues Manifest vorbereiten, bevor eine Datei ersetzt wird: Eintrag
+    // ersetzt bzw. eingefügt, alle späteren um inserted verschoben
+    uint32_t total = partitionCount + (exists ? 0 : 1);
+    PartitionEntry *entries = reservePartitions(total)
+                            ? (PartitionEntry *)malloc(total * sizeof(PartitionEntry)) : nullptr;
+    if (!entries) {
+        logFs->remove(MERGE_TMP_FILE);
+        return false;
+    }
+
+    memcpy(entries, partitions, slot * sizeof(PartitionEntry));
+    for (uint32_t i = slot + 1; i < total; i++) {
+        entries[i] = partitions[exists ? i : i - 1];
+        entries[i].firstIndex += inserted;
+    }
+
+    char rawPath[RECORD_FILE_PATH_MAX];
+    char blkPath[RECORD_FILE_PATH_MAX];
+    partitionPath(merged.first, rawPath, sizeof(rawPath), ".bin");
+    partitionPath(merged.first, blkPath, sizeof(blkPath), ".blk");
+    makePartitionDirs(merged.first);
+
+    if (newest) {
+        current.close();
+        ok = replaceFile(MERGE_TMP_FILE, rawPath);
+        merged.format = PARTITION_RAW;
+    } else if (exists && entry.format == PARTITION_COMPRESSED) {
+        // Roh daneben, sensorLogCompact() komprimiert sie wieder; eine .bin
+        // an dieser Stelle stammt von einem abgebrochenen Versuch
+        logFs->remove(rawPath);
+        ok = logFs->rename(MERGE_TMP_FILE, rawPath);
+        merged.format = PARTITION_RAW;
+    } else {
+        ok = sensorCodecCompress(*logFs, MERGE_TMP_FILE, merged.count, blkPath);
+        merged.format = PARTITION_COMPRESSED;
+    }
+    logFs->remove(MERGE_TMP_FILE);
+    entries[slot] = merged;
+
+    bool saved = false;
+    if (ok) {
+        logRevision++;
+        saved = saveManifest(entries, total);
+        if (!saved) logRevision--;
+    }
+
+    // Die jüngste gilt nach dem Ersetzen so oder so, beim Start zählt ihre Datei
+    if (saved || (ok && newest)) {
+        portENTER_CRITICAL(&logMux);
+        memcpy(partitions, entries, total * sizeof(PartitionEntry));
+        partitionCount = total;
+        durableCount = partitionsEnd();
+        portEXIT_CRITICAL(&logMux);
+    }
+    free(entries);
+
+    if (newest && !current.begin(*logFs)) ok = false;
+    if (!ok || !(saved || newest)) {
+        Serial.printf("Fehler beim Einsortieren in %s!\n", rawPath);
+        return false;
+    }
+
+    // Erst jetzt zeigt das Manifest auf die neue Datei
+    if (exists && entry.format != merged.format) logFs->remove(entry.format == PARTITION_RAW ? rawPath : blkPath);
+    return true;
+}
+
+uint32_t sensorLogMerge(uint32_t &from, void (*onInserted)(const SensorRecord &record)) {
+    if (!logReady || !backfillFile.ready() || !flushBackfill() || backfillFile.count() == 0) return 0;
+
+    // Nachlieferungen für den jüngsten Tag landen in der Datei, nicht im Puffer
+    if (!sensorLogFlush()) return 0;
+
+    MergeWorkspace *work = (MergeWorkspace *)(psramFound() ? ps_malloc(sizeof(MergeWorkspace)) : malloc(sizeof(MergeWorkspace)));
+    if (!work) {
+        Serial.println("Kein Speicher zum Einsortieren der Nachlieferungen!");
+        return 0;
+    }
+
+    uint32_t day;
+    uint32_t inserted = 0;
+    size_t taken = takeBackfill(*work, day);
+    bool merged = taken > 0 && mergeDay(*work, taken, inserted);
+
+    // Stehen im Log, auch wenn das Aufräumen scheitert: beim nächsten
+    // Versuch sind sie Duplikate und werden nicht noch einmal gemeldet
+    if (merged && inserted > 0) {
+        from = UINT32_MAX;
+        for (size_t i = 0; i < taken; i++) {
+            if (work->duplicate[i]) continue;
+            if (from == UINT32_MAX) from = work->batch[i].timestamp;
+            if (onInserted) onInserted(work->batch[i]);
+        }
+    }
+
+    bool ok = merged && dropBackfill(*work, day, taken);
+    if (ok && inserted > 0) {
+        Serial.printf("Log: %lu Nachlieferungen einsortiert, %lu warten noch\n",
+                      (unsigned long)inserted, (unsigned long)backfillFile.count());
+    }
+
+    free(work);
+    return ok ? inserted : 0;
+}
+
+bool sensorLogCompact() {
+    if (!logReady) return false;
+
+    // Älteste noch rohe Partition; die jüngste wird noch beschrieben
+    uint32_t slot = 0;
+    while (slot + 1 < partitionCount && partitions[slot].format != PARTITION_RAW) slot++;
+    if (slot + 1 >= partitionCount) return false;
+
+    PartitionEntry entry = partitions[slot];
+    char rawPath[RECORD_FILE_PATH_MAX];
+    char path[RECORD_FILE_PATH_MAX];
+    partitionPath(entry.first, rawPath, sizeof(rawPath), ".bin");
+    partitionPath(entry.first, path, sizeof(path), ".blk");
+
+    if (!sensorCodecCompress(*logFs, rawPath, entry.count, path)) {
+        Serial.printf("Fehler beim Komprimieren von %s!\n", rawPath);
+        return false;
+    }
+
+    // Erst das Manifest, dann die Rohdatei weg; bis dahin lesen Leser noch aus ihr
+    entry.format = PARTITION_COMPRESSED;
+    if (!manifestFile.write(slot, &entry)) return false;
+
+    portENTER_CRITICAL(&logMux);
+    partitions[slot].format = PARTITION_COMPRESSED;
+    portEXIT_CRITICAL(&logMux);
+
+    logFs->remove(rawPath);
+    return true;
+}
+
+static bool isLegacyLog(fs::FS &fs) {
+    File file = fs.open(SENSOR_LOG_FILE, FILE_READ);
+    if (!file) return false;
+
+    RecordFileHeader header;
+    size_t len = file.read((uint8_t *)&header, sizeof(header));
+    file.close();
+
+    return len == sizeof(header) && header.magic == SENSOR_LOG_MAGIC && header.version == 1;
+}
+
+bool sensorLogNeedsMigration(fs::FS &fs) {
+    return fs.exists(SENSOR_LOG_CSV_FILE) || isLegacyLog(fs);
+}
+
+// Eine CSV-Zeile ("2026-10-18T12:00:00;21.50;...") im Format v1
+static bool parseCsvLine(const char *line, LegacyRecord &record) {
+    struct tm timeinfo;
+    memset(&timeinfo, 0, sizeof(timeinfo));
+
+    // Trenner zwischen Datum und Uhrzeit war mal ' ', mal 'T'
+    int consumed = 0;
+    if (sscanf(line, "%d-%d-%d%*c%d:%d:%d%n",
+               &timeinfo.tm_year, &timeinfo.tm_mon, &timeinfo.tm_mday,
+               &timeinfo.tm_hour, &timeinfo.tm_min, &timeinfo.tm_sec, &consumed) != 6) {
+        return false;
+    }
+
+    timeinfo.tm_year -= 1900;
+    timeinfo.tm_mon -= 1;
+    timeinfo.tm_isdst = -1;
+
+    // Die CSV enthielt Ortszeit, die TZ ist durch configTime() gesetzt
+    time_t epoch = mktime(&timeinfo);
+    if (epoch < (time_t)SENSOR_LOG_MIN_VALID_TIME) return false;
+    record.timestamp = (uint32_t)epoch;
+
+    const char *p = line + consumed;
+    for (int i = 0; i < LEGACY_COLUMNS; i++) {
+        if (*p != ';') return false;
+        char *end;
+        record.values[i] = strtof(p + 1, &end);
+        if (end == p + 1) return false;
+        p = end;
+    }
+    return true;
+}
+
+// Alte Zeile -> Datensatz für den ESP32 und ggf. den Pico (nur Nullen = nie gesendet)
+static size_t splitLegacy(const LegacyRecord &legacy, uint8_t localNode, uint8_t legacyNode, SensorRecord out[2]) {
+    size_t count = 0;
+
+    for (int part = 0; part < 2; part++) {
+        const float *values = legacy.values + part * 3;
+        if (part == 1 && values[0] == 0.0f && values[1] == 0.0f && values[2] == 0.0f) continue;
+
+        SensorRecord &record = out[count++];
+        memset(&record, 0, sizeof(record));
+        record.timestamp = legacy.timestamp;
+        record.node = part == 0 ? localNode : legacyNode;
+        record.valid = 0x07;
+        memcpy(record.values, values, 3 * sizeof(float));
+    }
+
+    return count;
+}
+
+static uint32_t migrateCsv(fs::FS &fs, File &out, uint8_t localNode, uint8_t legacyNode) {
+    File csv = fs.open(SENSOR_LOG_CSV_FILE, FILE_READ);
+    if (!csv) return 0;
+
+    char csvLine[128];
+    uint32_t written = 0;
+    uint32_t skipped = 0;
+    LegacyRecord legacy;
+    SensorRecord records[2];
+
+    while (csv.available()) {
+        size_t len = csv.readBytesUntil('\n', csvLine, sizeof(csvLine) - 1);
+        csvLine[len] = '\0';
+
+        if (strncmp(csvLine, "Timestamp", 9) == 0 || len < 10) continue;
+
+        if (!parseCsvLine(csvLine, legacy)) {
+            skipped++;
+            continue;
+        }
+
+        size_t count = splitLegacy(legacy, localNode, legacyNode, records);
+        out.write((const uint8_t *)records, count * sizeof(SensorRecord));
+        written += count;
+    }
+
+    csv.close();
+    Serial.printf("CSV übernommen: %lu Datensätze, %lu Zeilen übersprungen\n",
+                  (unsigned long)written, (unsigned long)skipped);
+    return written;
+}
+
+static uint32_t migrateV1(fs::FS &fs, File &out, uint8_t localNode, uint8_t legacyNode) {
+    File in = fs.open(SENSOR_LOG_FILE, FILE_READ);
+    if (!in) return 0;
+
+    uint32_t written = 0;
+    LegacyRecord legacy;
+    SensorRecord records[2];
+
+    in.seek(sizeof(RecordFileHeader));
+    while (in.read((uint8_t *)&legacy, sizeof(legacy)) == sizeof(legacy)) {
+        size_t count = splitLegacy(legacy, localNode, legacyNode, records);
+        out.write((const uint8_t *)records, count * sizeof(SensorRecord));
+        written += count;
+    }
+
+    in.close();
+    Serial.printf("Log v1 übernommen: %lu Datensätze\n", (unsigned long)written);
+    return written;
+}
+
+uint32_t sensorLogMigrate(fs::FS &fs, uint8_t localNode, uint8_t legacyNode) {
+    bool legacyLog = isLegacyLog(fs);
+    bool csv = fs.exists(SENSOR_LOG_CSV_FILE);
+    if (!legacyLog && !csv) return 0;
+
+    // Log im aktuellen Format existiert schon (z.B. Neustart zwischen den
+    // rename()-Aufrufen): nur noch die CSV beiseite legen
+    if (csv && !legacyLog && (fs.exists(SENSOR_LOG_FILE) || fs.exists(SENSOR_LOG_MANIFEST_FILE))) {
+        fs.rename(SENSOR_LOG_CSV_FILE, SENSOR_LOG_CSV_FILE ".bak");
+        return 0;
+    }
+
+    Serial.println("Übernehme alte Log-Daten...");
+
+    // Erst in eine temporäre Datei schreiben, damit ein Abbruch kein halbes Log hinterlässt
+    if (!RecordFile::create(fs, SENSOR_LOG_TMP_FILE, SENSOR_LOG_MAGIC, SENSOR_LOG_VERSION,
+                            sizeof(SensorRecord), SENSOR_LOG_VALUES)) {
+        Serial.println("Fehler beim Anlegen der Migrationsdatei!");
+        return 0;
+    }
+    File out = fs.open(SENSOR_LOG_TMP_FILE, FILE_APPEND);
+    if (!out) return 0;
+
+    // Die CSV ist immer älter als ein v1-Log, das aus ihr entstanden ist
+    uint32_t written = 0;
+    if (csv && !legacyLog) written += migrateCsv(fs, out, localNode, legacyNode);
+    if (legacyLog) written += migrateV1(fs, out, localNode, legacyNode);
+    out.close();
+
+    if (legacyLog) fs.rename(SENSOR_LOG_FILE, SENSOR_LOG_V1_BACKUP);
+    fs.rename(SENSOR_LOG_TMP_FILE, SENSOR_LOG_FILE);
+    if (csv) fs.rename(SENSOR_LOG_CSV_FILE, SENSOR_LOG_CSV_FILE ".bak");
+
+    return written;
+}
@@ -0,0 +1,161 @@
+// sensor_log.h - Binäres Zeitreihen-Log auf der SD-Karte
+//
+// Das Log besteht aus einer SensorRecord (32 Byte) pro Messung eines Nodes.
+// Die Datensätze aller Nodes liegen zeitlich sortiert hintereinander; welcher
+// Node und welche Kanäle gemeint sind, steht im Satz selbst.
+//
+// Auf der Karte ist es in Tages-Partitionen (UTC) aufgeteilt, jede eine
+// RecordFile (siehe record_file.h): /log/2026/10/18.bin. Das Manifest
+// /log/manifest.bin hält je Partition ersten und letzten Zeitstempel, den
+// Log-Index des ersten Satzes und die Anzahl; es liegt beim Betrieb im RAM.
+// Indizes laufen über alle Partitionen durch, Lesen per Index bleibt O(1)
+// und eine Zeitabfrage öffnet nur die Partitionen, die sie berührt. Alte
+// Tage lassen sich als ganze Dateien löschen (sensorLogPrune), danach
+// beginnt das Log bei sensorLogFirstIndex() statt bei 0.
+//
+// Nur die jüngste Partition wird beschrieben. Abgeschlossene Tage schreibt
+// der storage-Task mit sensorLogCompact() blockweise komprimiert um
+// (DD.blk, siehe sensor_codec.h; Werte auf 0,01 gerundet); gelesen wird
+// transparent aus beiden Formaten.
+//
+// Nachgelieferte Sätze (ein Node lädt nach einem Ausfall seinen Puffer hoch)
+// sind älter als das Ende des Logs. sensorLogBackfill() legt sie in
+// /log/backfill.bin ab, sensorLogMerge() sortiert sie später tageweise in
+// ihre Partition ein. Alle Indizes dahinter verschieben sich dabei; wer
+// Indizes hält (Messwert-Puffer, Rollups, ?since=-Cursor), erkennt das an
+// sensorLogRevision().
+//
+// Geschrieben wird gepuffert: neue Sätze sammeln sich im RAM und gehen als
+// ein Block von SENSOR_LOG_BATCH_RECORDS Sätzen (512 Byte = ein Sektor) auf
+// die Karte, spätestens nach SENSOR_LOG_FLUSH_INTERVAL. Vor jedem Block
+// steht er im Journal /sensor_log.jnl; bricht das Schreiben ab, wird er beim
+// nächsten Start aus dem Journal wiederholt. Ein Stromausfall kostet so
+// höchstens den Block im RAM. Lesen, Zählen und Suchen sehen gepufferte
+// Sätze schon vorher.
+#ifndef SENSOR_LOG_H
+#define SENSOR_LOG_H
+
+#include <Arduino.h>
+#include "FS.h"
+#include "record_file.h"
+
+#define SENSOR_LOG_FILE         "/sensor_log.bin"   // bis v2 ein Log für alles, wird beim Start aufgeteilt
+#define SENSOR_LOG_CSV_FILE     "/sensor_log.csv"
+#define SENSOR_LOG_MAGIC        0x474C5348UL   // "HSLG"
+#define SENSOR_LOG_VERSION      2
+#define SENSOR_LOG_VALUES       6              // Werte pro Datensatz = Kanäle pro Node
+#define SENSOR_VALUE_MAX        1e6f           // Beträge ab hier sind Messfehler, nicht geloggt
+
+#define SENSOR_LOG_JOURNAL_FILE     "/sensor_log.jnl"
+#define SENSOR_LOG_BATCH_RECORDS    16              // Sätze pro Schreibvorgang
+#define SENSOR_LOG_FLUSH_INTERVAL   300000UL        // ms, spätestens dann wird geschrieben
+
+#define SENSOR_LOG_DIR                  "/log"
+#define SENSOR_LOG_MANIFEST_FILE        "/log/manifest.bin"
+#define SENSOR_LOG_MANIFEST_MAGIC       0x4D4C5348UL    // "HSLM"
+#define SENSOR_LOG_MANIFEST_VERSION     2
+#define SENSOR_LOG_PARTITION_SECONDS    86400UL         // eine Partition je UTC-Tag
+
+#define SENSOR_LOG_BACKFILL_FILE        "/log/backfill.bin"
+#define SENSOR_LOG_BACKFILL_MAX         8192            // wartende Nachlieferungen, 256 KB
+#define SENSOR_LOG_MERGE_RECORDS        512             // Sätze je sensorLogMerge()
+
+// Tage, die das Log aufbewahrt; ältere Partitionen löscht der storage-Task.
+// 0 = alles behalten
+#ifndef SENSOR_LOG_RETENTION_DAYS
+#define SENSOR_LOG_RETENTION_DAYS 0
+#endif
+
+// Alles davor ist "Zeit noch nicht per NTP gesetzt" (2020-01-01)
+#define SENSOR_LOG_MIN_VALID_TIME 1577836800UL
+
+struct SensorRecord {
+    uint32_t timestamp;                     // Unix-Zeit (UTC)
+    uint8_t node;                           // Index in der Node-Registry
+    uint8_t valid;                          // Bit i gesetzt = values[i] gemessen
+    uint16_t reserved;
+    float values[SENSOR_LOG_VALUES];        // in der Kanalreihenfolge des Nodes
+};
+
+static_assert(sizeof(SensorRecord) == 32, "SensorRecord muss 32 Byte haben");
+
+// Lädt das Manifest und öffnet die jüngste Partition; ein Log im alten
+// Format (eine Datei) wird dabei einmalig aufgeteilt und bleibt als
+// /sensor_log.v2.bak liegen. Muss nach SD.begin() laufen.
+bool sensorLogBegin(fs::FS &fs);
+
+// true, wenn sensorLogBegin() erfolgreich war
+bool sensorLogReady();
+
+// Hängt einen Datensatz an (zunächst im RAM). Ist der Block voll, wird er
+// geschrieben; ein halb geschriebener Satz am Dateiende (Stromausfall) wird
+// dabei überschrieben. false nur, wenn der Puffer voll ist und sich nicht
+// schreiben lässt. Nur aus dem storage-Task aufrufen.
+bool sensorLogAppend(const SensorRecord &record);
+
+// Gepufferte Sätze jetzt schreiben; der storage-Task ruft das alle
+// SENSOR_LOG_FLUSH_INTERVAL auf. Nur aus dem storage-Task aufrufen.
+bool sensorLogFlush();
+
+// true, wenn weder neue Sätze noch Nachlieferungen nur im RAM liegen
+bool sensorLogWritten();
+
+// Index hinter dem letzten Datensatz, gepufferte eingeschlossen. Nach
+// sensorLogPrune() ist das nicht mehr die Anzahl, siehe sensorLogFirstIndex().
+uint32_t sensorLogCount();
+
+// Ältester noch vorhandener Index; 0, solange nichts gelöscht wurde
+uint32_t sensorLogFirstIndex();
+
+// Zeitstempel des jüngsten Satzes, gepufferte eingeschlossen; 0 = leer
+uint32_t sensorLogNewest();
+
+// Steigt mit jedem sensorLogMerge(), das Sätze eingefügt hat, und bleibt
+// über Neustarts erhalten. Solange sie gleich bleibt, gilt ein Index weiter.
+uint32_t sensorLogRevision();
+
+bool sensorLogRead(uint32_t index, SensorRecord &record);
+
+// Liest bis zu maxRecords Sätze ab Index first, gibt die Anzahl gelesener zurück
+size_t sensorLogReadRange(uint32_t first, SensorRecord *records, size_t maxRecords);
+
+// Erster Index mit timestamp >= t: binäre Suche im Manifest, dann in einer
+// Partition (O(log n) Lesezugriffe). Setzt voraus, dass die Datensätze
+// zeitlich sortiert sind.
+uint32_t sensorLogLowerBound(uint32_t t);
+
+// Löscht alle Partitionen, deren jüngster Satz vor before liegt (die
+// jüngste nie). Gibt die Anzahl gelöschter Datensätze zurück. Nur aus dem
+// storage-Task aufrufen.
+uint32_t sensorLogPrune(uint32_t before);
+
+// Nimmt einen Satz an, der älter ist als sensorLogNewest(). Er wartet (wie
+// beim Anhängen zunächst im RAM) in SENSOR_LOG_BACKFILL_FILE und ist für
+// Leser erst nach sensorLogMerge() da. false, wenn dort kein Platz mehr ist.
+// Nur aus dem storage-Task aufrufen.
+bool sensorLogBackfill(const SensorRecord &record);
+
+// Sortiert bis zu SENSOR_LOG_MERGE_RECORDS wartende Sätze des ältesten Tages
+// in dessen Partition ein; Sätze, die es dort schon gibt (gleicher Node und
+// Zeitstempel), fallen weg. Gibt die Anzahl eingefügter Sätze zurück, from ist
+// dann der älteste davon. 0, wenn nichts wartet oder ein Fehler auftrat.
+// onInserted bekommt jeden tatsächlich eingefügten Satz genau einmal.
+// Nur aus dem storage-Task aufrufen.
+uint32_t sensorLogMerge(uint32_t &from, void (*onInserted)(const SensorRecord &record) = nullptr);
+
+// Komprimiert die älteste noch rohe Partition außer der jüngsten. false, wenn
+// es keine mehr gibt (oder ein Fehler auftrat). Nur aus dem storage-Task aufrufen.
+bool sensorLogCompact();
+
+// true, wenn noch eine alte CSV oder ein Log im Format v1 (feste Spalten
+// ESP32 + Pico) auf der Karte liegt
+bool sensorLogNeedsMigration(fs::FS &fs);
+
+// Einmalige Übernahme der alten Formate. Jede alte Zeile wird zu einem
+// Datensatz für localNode und - sofern der Pico Werte hatte - einem für
+// legacyNode; beide Nodes müssen die Kanäle Temperatur, Feuchte, Druck in
+// dieser Reihenfolge haben. Alte Dateien bleiben als *.bak liegen.
+// Gibt die Anzahl geschriebener Datensätze zurück.
+uint32_t sensorLogMigrate(fs::FS &fs, uint8_t localNode, uint8_t legacyNode);
+
+#endif
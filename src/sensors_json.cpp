@@ -0,0 +1,91 @@
+#include "sensors_json.h"
+#include <new>
+#include <time.h>
+
+static std::shared_ptr<const SensorsBody> cached;
+static uint32_t cachedVersion = 0;
+static uint32_t cachedWeather = 0;
+
+// Alles vom Wetter, was in der Antwort steht: Abrufzeit, Fehler und Text
+// (FNV-1a). Ein fehlgeschlagener Abruf ändert nur lastError und den Text.
+static uint32_t weatherKey(const WeatherState &weather) {
+    uint32_t hash = 2166136261UL;
+    for (const char *c = weather.description; *c; c++) hash = (hash ^ (uint8_t)*c) * 16777619UL;
+
+    hash = (hash ^ weather.fetchedAt) * 16777619UL;
+    return (hash ^ (uint32_t)weather.lastError) * 16777619UL;
+}
+
+void sensorsJsonWrite(JsonWriter &json, const WeatherState &weather,
+                      const NodeInfo *nodes, uint8_t total, uint32_t version) {
+    // Zeit der letzten lokalen Messung, statt des globalen currentTime
+    char timestamp[32] = "Loading...";
+    time_t measuredAt = total > NODE_LOCAL ? nodes[NODE_LOCAL].lastSeen : 0;
+    if (measuredAt) {
+        struct tm timeinfo;
+        localtime_r(&measuredAt, &timeinfo);
+        strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%S", &timeinfo);
+    }
+
+    json.beginObject();
+    json.addString("weather", weather.description);
+    json.addUnsigned("weather_updated", weather.fetchedAt);
+    json.addString("timestamp", timestamp);
+    json.addUnsigned("version", version);
+
+    json.beginArray("nodes");
+    for (uint8_t i = 0; i < total; i++) {
+        const NodeInfo &node = nodes[i];
+
+        json.beginObject();
+        json.addString("id", node.id);
+        json.addUnsigned("last_seen", node.lastSeen);
+
+        json.beginObject("values");
+        for (int slot = 0; slot < node.channelCount; slot++) {
+            if (node.valid & (1 << slot)) json.addFloat(channelKindName(node.channels[slot]), node.values[slot]);
+        }
+        json.endObject();
+
+        json.endObject();
+    }
+    json.endArray();
+    json.endObject();
+}
+
+std::shared_ptr<const SensorsBody> sensorsJsonCurrent(const WeatherState &weather) {
+    uint32_t weatherNow = weatherKey(weather);
+    if (cached && cachedVersion == nodeVersion() && cachedWeather == weatherNow) return cached;
+
+    // Ein konsistenter Stand aller Nodes, kopiert ohne den Ingest aufzuhalten
+    std::unique_ptr<NodeInfo[]> nodes(new (std::nothrow) NodeInfo[NODE_MAX]);
+    if (!nodes) return cached;
+    uint8_t total;
+    uint32_t version = nodeSnapshot(nodes.get(), total);
+
+    // Erst zählen, dann genau passend schreiben
+    JsonWriter measure(nullptr, 0);
+    sensorsJsonWrite(measure, weather, nodes.get(), total, version);
+
+    std::shared_ptr<SensorsBody> body(new (std::nothrow) SensorsBody);
+    if (!body) return cached;
+    body->json.reset(new (std::nothrow) char[measure.length() + 1]);
+    if (!body->json) return cached;
+
+    JsonWriter json(body->json.get(), measure.length() + 1);
+    sensorsJsonWrite(json, weather, nodes.get(), total, version);
+    body->length = json.length();
+
+    // Die Version beginnt nach jedem Neustart von vorn, die jüngste Messzeit nicht
+    uint32_t newest = 0;
+    for (uint8_t i = 0; i < total; i++) {
+        if (nodes[i].lastSeen > newest) newest = nodes[i].lastSeen;
+    }
+    snprintf(body->etag, sizeof(body->etag), "\"%lx-%lx-%lx\"",
+             (unsigned long)version, (unsigned long)newest, (unsigned long)weatherNow);
+
+    cached = body;
+    cachedVersion = version;
+    cachedWeather = weatherNow;
+    return cached;
+}
@@ -0,0 +1,39 @@
+// sensors_json.h - Aufbau der /sensors-Antwort
+//
+//   {"weather":"12C, leichter Regen","weather_updated":<unix>,
+//    "timestamp":"2025-01-01T12:00:00","version":<n>,
+//    "nodes":[{"id":"esp32","last_seen":<unix>,"values":{"temperature":21.50,...}},...]}
+//
+// timestamp ist die Zeit der letzten lokalen Messung, version der Stand der
+// Node-Registry (nodeSnapshot()). Die Antwort ändert sich nur mit einer
+// neuen Messung, einem neuen Node oder neuem Wetter (auch nur neuem
+// Fehlertext nach einem fehlgeschlagenen Abruf); sensorsJsonCurrent()
+// serialisiert sie deshalb nur dann neu und liefert sonst den fertigen Body
+// samt ETag. Liegt ohne Webserver in einem eigenen Modul, damit es auch in
+// der native-Umgebung (bench/) läuft.
+#ifndef SENSORS_JSON_H
+#define SENSORS_JSON_H
+
+#include <Arduino.h>
+#include "json_writer.h"
+#include "node_registry.h"
+#include "weather.h"
+#include <memory>
+
+// Fertig serialisierte Antwort. Unveränderlich; eine laufende Antwort hält
+// ihren Stand fest, auch wenn inzwischen ein neuer gebaut wurde.
+struct SensorsBody {
+    char etag[32];              // "\"<Node-Version>-<letzte Messung>-<Wetter-Hash>\"" (hex), mit Anführungszeichen
+    size_t length;
+    std::unique_ptr<char[]> json;
+};
+
+void sensorsJsonWrite(JsonWriter &json, const WeatherState &weather,
+                      const NodeInfo *nodes, uint8_t total, uint32_t version);
+
+// Aktueller Body zum Wetterstand weather; neu gebaut nur, wenn sich Nodes
+// oder Wetter seit dem letzten Aufruf geändert haben. nullptr ohne Speicher.
+// Nicht nebenläufig aufrufen (nur aus dem Webserver-Task).
+std::shared_ptr<const SensorsBody> sensorsJsonCurrent(const WeatherState &weather);
+
+#endif
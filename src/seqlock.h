@@ -0,0 +1,55 @@
+// seqlock.h - Lesen ohne Sperre für Daten, die selten geschrieben werden
+//
+// Schreiber machen den Zähler vor der Änderung ungerade und danach wieder
+// gerade; Schreiber untereinander müssen sich weiterhin selbst ausschließen
+// (z.B. mit einem Spinlock). Leser kopieren die Daten und prüfen danach, ob
+// der Zähler gleich geblieben ist - sonst war ein Schreiber dazwischen und
+// sie kopieren noch einmal. Ein Leser hält so nie einen Schreiber auf.
+//
+//   do {
+//       start = lock.readBegin();
+//       copy = shared;
+//   } while (lock.readRetry(start));
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <atomic>
+#include <stdint.h>
+
+class SeqLock {
+public:
+    SeqLock() : sequence(0) {}
+
+    void writeBegin() {
+        sequence.store(sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    void writeEnd() {
+        sequence.store(sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // Wartet, bis kein Schreiber aktiv ist
+    uint32_t readBegin() const {
+        uint32_t start;
+        while ((start = sequence.load(std::memory_order_acquire)) & 1) {
+        }
+        return start;
+    }
+
+    // true, wenn die gelesene Kopie verworfen werden muss
+    bool readRetry(uint32_t start) const {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return sequence.load(std::memory_order_relaxed) != start;
+    }
+
+    // Zählt abgeschlossene Änderungen
+    uint32_t version() const {
+        return sequence.load(std::memory_order_acquire) >> 1;
+    }
+
+private:
+    std::atomic<uint32_t> sequence;
+};
+
+#endif
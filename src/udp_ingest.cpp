@@ -0,0 +1,155 @@
+#include "udp_ingest.h"
+#include "ingest.h"
+#include "node_registry.h"
+#include <AsyncUDP.h>
+
+static AsyncUDP udp;
+
+// Liest little-endian Felder aus dem Datagramm, ok wird false beim Überlauf
+struct PacketReader {
+    const uint8_t *pos;
+    const uint8_t *end;
+    bool ok;
+
+    bool take(void *out, size_t len) {
+        if (!ok || (size_t)(end - pos) < len) {
+            ok = false;
+            return false;
+        }
+        memcpy(out, pos, len);
+        pos += len;
+        return true;
+    }
+
+    uint8_t u8() {
+        uint8_t v = 0;
+        take(&v, sizeof(v));
+        return v;
+    }
+
+    uint16_t u16() {
+        uint8_t b[2] = { 0, 0 };
+        take(b, sizeof(b));
+        return b[0] | (uint16_t)b[1] << 8;
+    }
+
+    uint32_t u32() {
+        uint8_t b[4] = { 0, 0, 0, 0 };
+        take(b, sizeof(b));
+        return b[0] | (uint32_t)b[1] << 8 | (uint32_t)b[2] << 16 | (uint32_t)b[3] << 24;
+    }
+
+    float f32() {
+        uint32_t bits = u32();
+        float v;
+        memcpy(&v, &bits, sizeof(v));
+        return v;
+    }
+};
+
+static size_t writeAck(uint8_t *reply, uint8_t accepted, uint8_t rejected, IngestStatus status, uint32_t seq) {
+    reply[0] = UDP_INGEST_MAGIC & 0xFF;
+    reply[1] = UDP_INGEST_MAGIC >> 8;
+    reply[2] = UDP_INGEST_VERSION;
+    reply[3] = UDP_INGEST_FLAG_REPLY;
+    reply[4] = accepted;
+    reply[5] = rejected;
+    reply[6] = status;
+    reply[7] = 0;
+    for (int i = 0; i < 4; i++) reply[8 + i] = seq >> (8 * i);
+    return UDP_INGEST_ACK_LEN;
+}
+
+// Prüft alle Messungen ab reader, ohne etwas zu übernehmen: jede Kanalmaske
+// nur mit bekannten Kanälen und genau so viele Werte, wie das Paket lang ist
+static bool samplesValid(PacketReader reader, uint8_t count) {
+    for (uint8_t i = 0; i < count && reader.ok; i++) {
+        reader.u32();
+        reader.u32();
+        uint8_t mask = reader.u8();
+
+        // Unbekanntes Bit: wie viele Werte folgen, ist nicht zu sagen
+        if (mask >> CHANNEL_KINDS) return false;
+
+        for (uint8_t kind = 0; kind < CHANNEL_KINDS; kind++) {
+            if (mask & (1 << kind)) reader.f32();
+        }
+    }
+    return reader.ok && reader.pos == reader.end;
+}
+
+size_t udpIngestHandle(const uint8_t *data, size_t len, uint8_t *reply) {
+    PacketReader reader = { data, data + len, true };
+
+    if (reader.u16() != UDP_INGEST_MAGIC || reader.u8() != UDP_INGEST_VERSION) return 0;
+
+    uint8_t flags = reader.u8();
+    uint8_t idLen = reader.u8();
+    if (!reader.ok || idLen == 0 || idLen >= NODE_ID_LEN) return 0;
+
+    char id[NODE_ID_LEN];
+    if (!reader.take(id, idLen)) return 0;
+    id[idLen] = '\0';
+
+    // Kaputtes Paket ganz abweisen, bevor ein Node angelegt oder etwas geloggt wird
+    uint8_t count = reader.u8();
+    if (!reader.ok || !samplesValid(reader, count)) {
+        if (!(flags & UDP_INGEST_FLAG_ACK)) return 0;
+        return writeAck(reply, 0, count, INGEST_PARSE_ERROR, 0);
+    }
+
+    int node = nodeRegister(id);
+    if (node < 0) return 0;
+
+    uint8_t accepted = 0;
+    uint8_t rejected = 0;
+    IngestStatus firstError = INGEST_OK;
+
+    for (uint8_t i = 0; i < count && reader.ok; i++) {
+        uint32_t seq = reader.u32();
+        uint32_t timestamp = reader.u32();
+        uint8_t mask = reader.u8();
+
+        uint8_t kinds[CHANNEL_KINDS];
+        float values[CHANNEL_KINDS];
+        size_t channels = 0;
+
+        for (uint8_t kind = 0; kind < CHANNEL_KINDS; kind++) {
+            if (!(mask & (1 << kind))) continue;
+            kinds[channels] = kind;
+            values[channels] = reader.f32();
+            channels++;
+        }
+
+        IngestStatus status = ingestSample(node, timestamp, kinds, values, channels, seq);
+
+        // Eine Wiederholung ist für den Node erledigt wie eine angenommene Messung
+        if (status == INGEST_OK || status == INGEST_DUPLICATE) {
+            accepted++;
+            continue;
+        }
+
+        if (rejected++ == 0) firstError = status;
+        if (status == INGEST_QUEUE_FULL) break;
+    }
+
+    if (!(flags & UDP_INGEST_FLAG_ACK)) return 0;
+    return writeAck(reply, accepted, rejected, firstError, nodeSequenceNext(node));
+}
+
+bool udpIngestBegin() {
+    if (!udp.listen(UDP_INGEST_PORT)) {
+        Serial.println("UDP-Ingest konnte nicht starten!");
+        return false;
+    }
+
+    // Läuft im Task von AsyncUDP
+    udp.onPacket([](AsyncUDPPacket packet) {
+        uint8_t reply[UDP_INGEST_ACK_LEN];
+        size_t replyLen = udpIngestHandle(packet.data(), packet.length(), reply);
+        if (replyLen) packet.write(reply, replyLen);
+    });
+
+    Serial.printf("UDP-Ingest auf Port %d\n", UDP_INGEST_PORT);
+    return true;
+}
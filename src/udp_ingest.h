@@ -0,0 +1,50 @@
+// udp_ingest.h - Binärer Messwert-Eingang per UDP
+//
+// Ein Datagramm trägt eine oder mehrere Messungen eines Nodes, alle Zahlen
+// little-endian:
+//
+//   u16  magic      0x4E48 ("HN")
+//   u8   version    1
+//   u8   flags      Bit 0: Quittung erwünscht
+//   u8   idLen      1..NODE_ID_LEN-1, danach idLen Zeichen Node-ID
+//   u8   count      Anzahl Messungen, je Messung:
+//        u32  seq        laufende Nummer beim Node
+//        u32  timestamp  Unix-Zeit, 0 = Empfangszeit
+//        u8   kinds      Bit k = Kanal k (ChannelKind) ist enthalten, Bit 6/7 = 0
+//        f32  values[]   ein Wert je gesetztem Bit, aufsteigend nach k
+//
+// Eine Messung mit drei Kanälen kostet so 21 Byte plus 6 + idLen Byte Kopf
+// statt einer HTTP-Anfrage. Die Messungen gehen durch denselben Ingest wie
+// /api/nodes/<id>. Quittung (12 Byte):
+//
+//   u16 magic, u8 version, u8 flags = 0x80, u8 accepted, u8 rejected,
+//   u8 status (IngestStatus der ersten Ablehnung), u8 reserved,
+//   u32 next_seq wie bei /api/nodes/<id>: alles darunter steht sicher im
+//       Log und kann beim Node gelöscht werden, 0 = noch nichts
+//
+// Schon angenommene seq (Quittung verloren, Paket wiederholt) zählen als
+// angenommen, werden aber nicht noch einmal geloggt. Ein Paket mit
+// unbekannten Kanal-Bits oder falscher Länge wird ganz abgewiesen
+// (rejected = count, status parse_error), bevor etwas übernommen wird.
+//
+// tools/udp_node_sim.py erzeugt solche Pakete zum Testen.
+#ifndef UDP_INGEST_H
+#define UDP_INGEST_H
+
+#include <Arduino.h>
+
+#define UDP_INGEST_PORT         4210
+#define UDP_INGEST_MAGIC        0x4E48
+#define UDP_INGEST_VERSION      1
+#define UDP_INGEST_FLAG_ACK     0x01
+#define UDP_INGEST_FLAG_REPLY   0x80
+#define UDP_INGEST_ACK_LEN      12
+
+// Listener auf UDP_INGEST_PORT starten (nach WiFi und ingestBegin())
+bool udpIngestBegin();
+
+// Wertet ein Datagramm aus. Schreibt die Quittung nach reply, wenn der
+// Node eine will, und gibt ihre Länge zurück (0 = keine Antwort).
+size_t udpIngestHandle(const uint8_t *data, size_t len, uint8_t *reply);
+
+#endif
@@ -0,0 +1,128 @@
+#include "weather.h"
+#include "secrets.h"
+#include "metrics.h"
+#include <WiFi.h>
+#include <HTTPClient.h>
+#include <ArduinoJson.h>
+#include <time.h>
+
+static WeatherState weather = { "Loading...", 0.0f, 0, 0, 0 };
+static portMUX_TYPE weatherMux = portMUX_INITIALIZER_UNLOCKED;
+
+void weatherGet(WeatherState &state) {
+    portENTER_CRITICAL(&weatherMux);
+    state = weather;
+    portEXIT_CRITICAL(&weatherMux);
+}
+
+// Fehlschlag festhalten; ein vorhandener gültiger Wert bleibt sichtbar
+static void storeFailure(int error, const char *message) {
+    portENTER_CRITICAL(&weatherMux);
+    weather.lastError = error;
+    if (weather.failures < 255) weather.failures++;
+    if (weather.fetchedAt == 0) {
+        strncpy(weather.description, message, sizeof(weather.description) - 1);
+        weather.description[sizeof(weather.description) - 1] = '\0';
+    }
+    portEXIT_CRITICAL(&weatherMux);
+}
+
+// Ein Abruf; true bei Erfolg
+static bool fetchWeather() {
+    if (WiFi.status() != WL_CONNECTED) {
+        storeFailure(-1, "Keine WiFi-Verbindung");
+        return false;
+    }
+
+    char url[256];
+    snprintf(
+        url,
+        sizeof(url),
+        WEATHER_BASE_URL "/data/2.5/weather?q=" WEATHER_CITY "&appid=%s&units=metric&lang=de",
+        WEATHER_API_KEY
+    );
+
+    HTTPClient http;
+    http.setConnectTimeout(WEATHER_HTTP_TIMEOUT);
+    http.setTimeout(WEATHER_HTTP_TIMEOUT);
+
+    Serial.println("Hole Wetterdaten...");
+    http.begin(url);
+    int httpCode = http.GET();
+
+    if (httpCode != 200) {
+        Serial.print("HTTP Fehler: ");
+        Serial.println(httpCode);
+        http.end();
+        storeFailure(httpCode, "Nicht verfuegbar");
+        return false;
+    }
+
+    // Nur die zwei benötigten Felder parsen, der Rest der Antwort wird übersprungen
+    JsonDocument filter;
+    filter["main"]["temp"] = true;
+    filter["weather"][0]["description"] = true;
+
+    JsonDocument doc;
+    DeserializationError error = deserializeJson(doc, *http.getStreamPtr(), DeserializationOption::Filter(filter));
+    http.end();
+
+    if (error) {
+        Serial.println("JSON Parse Fehler");
+        storeFailure(-2, "Fehler beim Parsen");
+        return false;
+    }
+
+    float temperature = doc["main"]["temp"];
+    const char *description = doc["weather"][0]["description"] | "";
+
+    char text[sizeof(weather.description)];
+    snprintf(text, sizeof(text), "%dC, %s", (int)round(temperature), description);
+
+    portENTER_CRITICAL(&weatherMux);
+    memcpy(weather.description, text, sizeof(text));
+    weather.temperature = temperature;
+    weather.fetchedAt = (uint32_t)time(nullptr);
+    weather.lastError = 0;
+    weather.failures = 0;
+    portEXIT_CRITICAL(&weatherMux);
+
+    Serial.print("Wetter aktualisiert: ");
+    Serial.println(text);
+    return true;
+}
+
+static void weatherTask(void *parameter) {
+    unsigned long delayMs = 0;
+
+    for (;;) {
+        if (delayMs) vTaskDelay(pdMS_TO_TICKS(delayMs));
+
+        unsigned long started = micros();
+        bool ok = fetchWeather();
+        metricsObserve(METRIC_WEATHER_FETCH, micros() - started);
+        metricsCount(ok ? METRIC_WEATHER_OK : METRIC_WEATHER_FAILED);
+
+        if (ok) {
+            delayMs = WEATHER_UPDATE_INTERVAL;
+        } else {
+            // Exponentielles Backoff: 1, 2, 4, ... Minuten
+            WeatherState state;
+            weatherGet(state);
+
+            uint8_t shift = state.failures > 8 ? 7 : state.failures - 1;
+            delayMs = WEATHER_RETRY_MIN << shift;
+            if (delayMs > WEATHER_UPDATE_INTERVAL) delayMs = WEATHER_UPDATE_INTERVAL;
+        }
+    }
+}
+
+static TaskHandle_t taskHandle = NULL;
+
+void weatherBegin(int core) {
+    xTaskCreatePinnedToCore(weatherTask, "weather", WEATHER_TASK_STACK, NULL, 1, &taskHandle, core);
+}
+
+TaskHandle_t weatherTaskHandle() {
+    return taskHandle;
+}
@@ -0,0 +1,46 @@
+// weather.h - OpenWeatherMap-Abruf in einem eigenen Task
+//
+// Der Abruf (blockierendes HTTPClient-GET + JSON) läuft nicht mehr im
+// /sensors-Handler auf dem AsyncTCP-Task, sondern im Task "weather".
+// Handler lesen nur noch den zwischengespeicherten Stand mit weatherGet().
+//
+// Nach einem erfolgreichen Abruf wird nach WEATHER_UPDATE_INTERVAL wieder
+// geholt, nach Fehlschlägen mit wachsendem Abstand (1, 2, 4, ... Minuten,
+// höchstens WEATHER_UPDATE_INTERVAL). Der zuletzt gültige Wert bleibt bis
+// dahin stehen.
+//
+// Zum Testen ohne API lässt sich der Server per Build-Flag umbiegen, z.B. auf
+// tools/weather_stub.py:  -D WEATHER_BASE_URL=\"http://192.168.1.20:8080\"
+#ifndef WEATHER_H
+#define WEATHER_H
+
+#include <Arduino.h>
+
+#ifndef WEATHER_BASE_URL
+#define WEATHER_BASE_URL "http://api.openweathermap.org"
+#endif
+
+#define WEATHER_CITY                "Mannheim"
+#define WEATHER_UPDATE_INTERVAL     6000000UL   // 100 Minuten
+#define WEATHER_RETRY_MIN           60000UL     // erster Wiederholversuch nach 1 Minute
+#define WEATHER_HTTP_TIMEOUT        5000        // ms
+#define WEATHER_TASK_STACK          8192        // HTTPClient + JSON-Filter brauchen gut 6 KB
+
+struct WeatherState {
+    char description[64];       // "12C, leichter Regen" bzw. Fehlertext
+    float temperature;
+    uint32_t fetchedAt;         // Unix-Zeit des letzten erfolgreichen Abrufs, 0 = noch nie
+    int lastError;              // 0 = letzter Abruf ok, sonst HTTP-Code bzw. HTTPClient-Fehler (< 0)
+    uint8_t failures;           // Fehlschläge in Folge
+};
+
+// Startet den Abruf-Task auf core; der erste Abruf folgt sofort
+void weatherBegin(int core);
+
+// Handle des Abruf-Tasks (für die Stack-Anzeige), NULL vor weatherBegin()
+TaskHandle_t weatherTaskHandle();
+
+// Kopie des aktuellen Stands, O(1) und ohne Netzwerkzugriff
+void weatherGet(WeatherState &state);
+
+#endif
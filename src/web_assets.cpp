@@ -0,0 +1,41 @@
+#include "web_assets.h"
+#include "metrics.h"
+#include <ESPAsyncWebServer.h>
+
+#define WEB_ASSETS_CACHE_IMMUTABLE "public, max-age=31536000, immutable"
+#define WEB_ASSETS_CACHE_REVALIDATE "no-cache"
+
+static void sendAsset(AsyncWebServerRequest *request, const WebAsset &asset) {
+    const char *cacheControl = asset.immutable ? WEB_ASSETS_CACHE_IMMUTABLE : WEB_ASSETS_CACHE_REVALIDATE;
+
+    // Browser hat die Datei schon: nur bestätigen
+    if (request->hasHeader("If-None-Match")
+        && strstr(request->header("If-None-Match").c_str(), asset.etag)) {
+        AsyncWebServerResponse *response = request->beginResponse(304);
+        response->addHeader("ETag", asset.etag);
+        response->addHeader("Cache-Control", cacheControl);
+        request->send(response);
+        return;
+    }
+
+    // Flash ist direkt adressierbar, gesendet wird ohne Kopie
+    AsyncWebServerResponse *response = request->beginResponse(200, asset.contentType, asset.data, asset.length);
+    response->addHeader("Content-Encoding", "gzip");
+    response->addHeader("ETag", asset.etag);
+    response->addHeader("Cache-Control", cacheControl);
+    request->send(response);
+}
+
+void webAssetsBegin(AsyncWebServer &server) {
+    for (size_t i = 0; i < webAssetCount; i++) {
+        const WebAsset *asset = &webAssets[i];
+        // Nur das Dashboard selbst geht in /metrics ein, die Assets sind Flash-Kopien
+        bool index = strcmp(asset->path, "/") == 0;
+
+        server.on(asset->path, HTTP_GET, [asset, index](AsyncWebServerRequest *request) {
+            unsigned long started = micros();
+            sendAsset(request, *asset);
+            if (index) metricsObserve(METRIC_HTTP_INDEX, micros() - started);
+        });
+    }
+}
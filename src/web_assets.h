@@ -0,0 +1,33 @@
+// web_assets.h - Dashboard-Dateien aus dem Flash, gzip-komprimiert
+//
+// Die Dateien unter web/ werden beim Build von tools/build_web_assets.py
+// komprimiert und als Tabelle nach web_assets_data.cpp geschrieben. Der
+// Browser bekommt sie unverändert mit Content-Encoding: gzip.
+//
+// Caching:
+//   - JS/CSS liegen unter /assets/<name>.<hash>.<ext> und ändern sich nie
+//     unter demselben Pfad -> "immutable", ein Jahr gültig.
+//   - "/" wird jedes Mal revalidiert; stimmt das ETag, gibt es 304 ohne Body.
+#ifndef WEB_ASSETS_H
+#define WEB_ASSETS_H
+
+#include <Arduino.h>
+
+struct WebAsset {
+    const char *path;
+    const char *contentType;
+    const char *etag;               // mit Anführungszeichen, wie im Header
+    const uint8_t *data;            // gzip
+    size_t length;
+    bool immutable;                 // Pfad enthält den Inhalts-Hash
+};
+
+extern const WebAsset webAssets[];
+extern const size_t webAssetCount;
+
+class AsyncWebServer;
+
+// Eine Route je Datei registrieren
+void webAssetsBegin(AsyncWebServer &server);
+
+#endif
@@ -0,0 +1,157 @@
+#!/usr/bin/env python3
+"""Packt das Dashboard (web/) gzip-komprimiert in die Firmware.
+
+Läuft als PlatformIO-Pre-Script (extra_scripts in platformio.ini) vor jedem
+Build und lässt sich auch direkt aufrufen:
+
+    python3 tools/build_web_assets.py
+
+Jede Datei aus ASSETS wird mit gzip -9 komprimiert und als Byte-Array nach
+src/web_assets_data.cpp geschrieben. JS/CSS bekommen einen Inhalts-Hash im
+Pfad (/assets/app.3f2a9c1b.js) und können damit für immer gecacht werden;
+index.html verweist über {{name}}-Platzhalter darauf und wird per ETag
+revalidiert. Die Ausgabe wird nur neu geschrieben, wenn sich etwas ändert.
+
+Chart.js liegt in web/vendor/. Fehlt die Datei, wird die festgelegte Version
+einmalig heruntergeladen - danach baut und läuft alles ohne Internet. Ob
+geladen oder vorhanden: die Datei muss CHART_JS_SHA256 entsprechen, sonst
+bricht der Build ab und nichts davon landet in der Firmware. Ist die
+Prüfsumme noch nicht eingetragen oder Chart.js weder vorhanden noch ladbar,
+wird ohne Diagramm gebaut (das Dashboard zeigt dann nur Werte und
+Statistik); die Warnung nennt die Prüfsumme der vorliegenden Datei - erst
+nach dem Vergleich mit einer zweiten Quelle (z.B. dem npm-Paket) übernehmen.
+"""
+
+import gzip
+import hashlib
+import os
+import re
+import sys
+import urllib.request
+
+CHART_JS_VERSION = "4.4.1"
+CHART_JS_URL = "https://cdn.jsdelivr.net/npm/chart.js@%s/dist/chart.umd.js" % CHART_JS_VERSION
+# sha256 von dist/chart.umd.js der Version oben; bei einem Versionswechsel mit ändern
+CHART_JS_SHA256 = ""
+
+# name im HTML -> (Quelldatei relativ zu web/, Content-Type)
+ASSETS = {
+    "style.css": ("style.css", "text/css"),
+    "app.js": ("app.js", "application/javascript"),
+    "chart.js": ("vendor/chart.umd.js", "application/javascript"),
+}
+INDEX = ("index.html", "text/html")
+
+
+def check_chart_js(data, origin):
+    """True, wenn data eingebaut werden darf; bei falscher Prüfsumme Abbruch."""
+    digest = hashlib.sha256(data).hexdigest()
+    if not CHART_JS_SHA256:
+        print("build_web_assets: WARNUNG - keine Prüfsumme für Chart.js %s eingetragen, baue ohne Diagramm.\n"
+              "%s hat sha256 %s - nach Vergleich als CHART_JS_SHA256 übernehmen."
+              % (CHART_JS_VERSION, origin, digest))
+        return False
+    if digest != CHART_JS_SHA256:
+        sys.exit("build_web_assets: %s hat sha256 %s, erwartet %s (Chart.js %s)."
+                 % (origin, digest, CHART_JS_SHA256, CHART_JS_VERSION))
+    return True
+
+
+def fetch_chart_js(path):
+    """True, wenn unter path ein geprüftes Chart.js liegt."""
+    if os.path.exists(path):
+        with open(path, "rb") as f:
+            return check_chart_js(f.read(), path)
+    print("build_web_assets: lade Chart.js %s nach %s" % (CHART_JS_VERSION, path))
+    try:
+        with urllib.request.urlopen(CHART_JS_URL, timeout=30) as response:
+            data = response.read()
+    except OSError as e:
+        print("build_web_assets: WARNUNG - Chart.js fehlt und kann nicht geladen werden (%s), baue ohne Diagramm.\n"
+              "Datei von %s nach %s legen." % (e, CHART_JS_URL, path))
+        return False
+
+    # Erst prüfen, dann speichern: eine falsche Datei bleibt nicht liegen
+    if not check_chart_js(data, CHART_JS_URL):
+        return False
+    os.makedirs(os.path.dirname(path), exist_ok=True)
+    with open(path, "wb") as f:
+        f.write(data)
+    return True
+
+
+def compress(data):
+    # mtime=0: gleicher Inhalt ergibt gleiche Bytes, der Build bleibt reproduzierbar
+    return gzip.compress(data, compresslevel=9, mtime=0)
+
+
+def c_array(symbol, data):
+    lines = []
+    for i in range(0, len(data), 20):
+        lines.append("    " + ", ".join("0x%02x" % b for b in data[i:i + 20]) + ",")
+    return "static const uint8_t %s[] PROGMEM = {\n%s\n};\n" % (symbol, "\n".join(lines))
+
+
+def build(root):
+    web = os.path.join(root, "web")
+    assets = dict(ASSETS)
+    if not fetch_chart_js(os.path.join(web, assets["chart.js"][0])):
+        del assets["chart.js"]
+
+    entries = []        # (url, content_type, etag, gz, immutable)
+    paths = {}
+
+    for name, (source, content_type) in assets.items():
+        with open(os.path.join(web, source), "rb") as f:
+            data = f.read()
+        digest = hashlib.sha256(data).hexdigest()
+        stem, ext = os.path.splitext(name)
+        url = "/assets/%s.%s%s" % (stem, digest[:8], ext)
+        paths[name] = url
+        entries.append((url, content_type, '"%s"' % digest[:16], compress(data), True))
+
+    with open(os.path.join(web, INDEX[0]), "r", encoding="utf-8") as f:
+        html = f.read()
+    for name, url in paths.items():
+        html = html.replace("{{%s}}" % name, url)
+    # Nicht eingebaute Dateien: die ganze Zeile mit dem Platzhalter entfällt
+    for name in ASSETS.keys() - assets.keys():
+        html = re.sub(r"[^\n]*\{\{%s\}\}[^\n]*\n" % re.escape(name), "", html)
+    data = html.encode("utf-8")
+    digest = hashlib.sha256(data).hexdigest()
+    entries.insert(0, ("/", INDEX[1], '"%s"' % digest[:16], compress(data), False))
+
+    out = ["// Erzeugt von tools/build_web_assets.py - nicht von Hand ändern", "",
+           '#include "web_assets.h"', ""]
+    for i, (_, _, _, gz, _) in enumerate(entries):
+        out.append(c_array("asset%d" % i, gz))
+
+    out.append("const WebAsset webAssets[] = {")
+    for i, (url, content_type, etag, gz, immutable) in enumerate(entries):
+        out.append('    { "%s", "%s", "%s", asset%d, %d, %s },'
+                   % (url, content_type, etag.replace('"', '\\"'), i, len(gz), "true" if immutable else "false"))
+    out.append("};")
+    out.append("")
+    out.append("const size_t webAssetCount = sizeof(webAssets) / sizeof(webAssets[0]);")
+    out.append("")
+    source = "\n".join(out)
+
+    target = os.path.join(root, "src", "web_assets_data.cpp")
+    if os.path.exists(target):
+        with open(target, "r", encoding="utf-8") as f:
+            if f.read() == source:
+                return
+    with open(target, "w", encoding="utf-8") as f:
+        f.write(source)
+
+    total = sum(len(e[3]) for e in entries)
+    print("build_web_assets: %d Dateien, %d Byte gzip" % (len(entries), total))
+    for url, _, _, gz, _ in entries:
+        print("  %-32s %6d Byte" % (url, len(gz)))
+
+
+try:
+    Import("env")  # noqa: F821 - nur unter PlatformIO definiert
+    build(env["PROJECT_DIR"])  # noqa: F821
+except NameError:
+    build(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
@@ -0,0 +1,188 @@
+#!/usr/bin/env python3
+"""Erzeugt UDP-Ingest-Pakete (siehe src/udp_ingest.h) wie ein Sensor-Node.
+
+    python3 tools/udp_node_sim.py --host 192.168.1.50 --node keller
+    python3 tools/udp_node_sim.py --host 192.168.1.50 --nodes 20 --rate 50 --count 5000
+    python3 tools/udp_node_sim.py --host 192.168.1.50 --batch 30 --ack
+
+Ohne ESP32 lässt sich das Format lokal prüfen: in einem Terminal
+
+    python3 tools/udp_node_sim.py --listen
+
+starten (dekodiert und quittiert wie die Firmware), im zweiten
+
+    python3 tools/udp_node_sim.py --host 127.0.0.1 --ack --count 10
+"""
+
+import argparse
+import math
+import random
+import socket
+import struct
+import time
+
+MAGIC = 0x4E48
+VERSION = 1
+FLAG_ACK = 0x01
+FLAG_REPLY = 0x80
+PORT = 4210
+
+# Reihenfolge wie ChannelKind in src/node_registry.h
+KINDS = ["temperature", "humidity", "pressure", "co2", "light", "battery"]
+STATUS = ["ok", "empty", "late", "future", "busy", "parse_error", "duplicate", "invalid"]
+
+
+def encode(node, samples, ack):
+    """samples: Liste von (seq, timestamp, {kind: wert})"""
+    node_id = node.encode()
+    packet = struct.pack("<HBBB", MAGIC, VERSION, FLAG_ACK if ack else 0, len(node_id)) + node_id
+    packet += struct.pack("<B", len(samples))
+
+    for seq, timestamp, values in samples:
+        mask = 0
+        floats = b""
+        for k, kind in enumerate(KINDS):
+            if kind in values:
+                mask |= 1 << k
+                floats += struct.pack("<f", values[kind])
+        packet += struct.pack("<IIB", seq, timestamp, mask) + floats
+
+    return packet
+
+
+def decode(packet):
+    magic, version, flags, id_len = struct.unpack_from("<HBBB", packet)
+    if magic != MAGIC or version != VERSION:
+        raise ValueError("falsches Magic/Version")
+
+    pos = 5
+    node = packet[pos:pos + id_len].decode()
+    pos += id_len
+    (count,) = struct.unpack_from("<B", packet, pos)
+    pos += 1
+
+    samples = []
+    for _ in range(count):
+        seq, timestamp, mask = struct.unpack_from("<IIB", packet, pos)
+        pos += 9
+        if mask >> len(KINDS):
+            raise ValueError("unbekannte Kanäle in Maske 0x%02x" % mask)
+        values = {}
+        for k, kind in enumerate(KINDS):
+            if mask & (1 << k):
+                (values[kind],) = struct.unpack_from("<f", packet, pos)
+                pos += 4
+        samples.append((seq, timestamp, values))
+
+    if pos != len(packet):
+        raise ValueError("%d überzählige Bytes" % (len(packet) - pos))
+    return node, flags, samples
+
+
+def encode_ack(accepted, rejected, status, next_seq):
+    return struct.pack("<HBBBBBBI", MAGIC, VERSION, FLAG_REPLY, accepted, rejected, status, 0, next_seq)
+
+
+def reading(node_index, t):
+    """Plausible, langsam driftende Werte"""
+    phase = t / 3600.0 + node_index
+    return {
+        "temperature": round(21.0 + 2.0 * math.sin(phase) + random.uniform(-0.05, 0.05), 2),
+        "humidity": round(45.0 + 5.0 * math.cos(phase), 1),
+        "pressure": round(1013.0 + random.uniform(-0.3, 0.3), 1),
+    }
+
+
+def listen(port):
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.bind(("0.0.0.0", port))
+    print("Warte auf Pakete an Port %d ..." % port)
+
+    while True:
+        packet, addr = sock.recvfrom(2048)
+        try:
+            node, flags, samples = decode(packet)
+        except (ValueError, struct.error) as e:
+            print("%s: ungültiges Paket (%d Byte): %s" % (addr[0], len(packet), e))
+            continue
+
+        for seq, timestamp, values in samples:
+            print("%s %-12s seq=%-6d ts=%d %s" % (addr[0], node, seq, timestamp, values))
+
+        if flags & FLAG_ACK and samples:
+            sock.sendto(encode_ack(len(samples), 0, 0, samples[-1][0] + 1), addr)
+
+
+def send(args):
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.settimeout(1.0)
+    target = (args.host, args.port)
+
+    names = [args.node] if args.nodes == 1 else ["%s%d" % (args.node, i) for i in range(args.nodes)]
+    seqs = [0] * len(names)
+    interval = 1.0 / args.rate if args.rate > 0 else 0
+    sent = 0
+    acked = 0
+    start = time.time()
+
+    while sent < args.count:
+        for i, name in enumerate(names):
+            samples = []
+            now = int(time.time()) - args.backfill
+            for b in range(args.batch):
+                seqs[i] += 1
+                # Gepufferte Messungen: ältere zuerst, im Abstand von --spacing Sekunden
+                timestamp = now - (args.batch - 1 - b) * args.spacing if args.timestamps else 0
+                samples.append((seqs[i], timestamp, reading(i, now)))
+
+            packet = encode(name, samples, args.ack)
+            sock.sendto(packet, target)
+            sent += len(samples)
+
+            if args.ack:
+                try:
+                    reply, _ = sock.recvfrom(64)
+                    _, _, _, accepted, rejected, status, _, next_seq = struct.unpack("<HBBBBBBI", reply)
+                    acked += accepted
+                    if rejected:
+                        print("%s: %d abgelehnt (%s), sicher im Log bis seq=%d"
+                              % (name, rejected, STATUS[status] if status < len(STATUS) else status, next_seq))
+                except socket.timeout:
+                    print("%s: keine Quittung" % name)
+
+            if sent >= args.count:
+                break
+            if interval:
+                time.sleep(interval)
+
+    elapsed = time.time() - start
+    print("%d Messungen in %.1f s gesendet (%.0f/s)%s"
+          % (sent, elapsed, sent / elapsed if elapsed else 0, ", %d quittiert" % acked if args.ack else ""))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--host", default="127.0.0.1")
+    parser.add_argument("--port", type=int, default=PORT)
+    parser.add_argument("--node", default="sim", help="Node-ID bzw. Präfix bei --nodes > 1")
+    parser.add_argument("--nodes", type=int, default=1, help="Anzahl simulierter Nodes")
+    parser.add_argument("--rate", type=float, default=1.0, help="Pakete pro Sekunde (0 = so schnell wie möglich)")
+    parser.add_argument("--count", type=int, default=60, help="Messungen insgesamt")
+    parser.add_argument("--batch", type=int, default=1, help="Messungen pro Paket")
+    parser.add_argument("--spacing", type=int, default=60, help="Sekunden zwischen gepufferten Messungen")
+    parser.add_argument("--backfill", type=int, default=0,
+                        help="Zeitstempel so viele Sekunden zurück, wie ein Node nach einem Ausfall")
+    parser.add_argument("--no-timestamps", dest="timestamps", action="store_false",
+                        help="Zeitstempel 0 senden, der Server setzt die Empfangszeit")
+    parser.add_argument("--ack", action="store_true", help="Quittung anfordern und auswerten")
+    parser.add_argument("--listen", action="store_true", help="Pakete empfangen und dekodieren statt senden")
+    args = parser.parse_args()
+
+    if args.listen:
+        listen(args.port)
+    else:
+        send(args)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,61 @@
+#!/usr/bin/env python3
+"""Lokaler Ersatz für die OpenWeatherMap-API zum Testen des Wetter-Tasks.
+
+Firmware mit  -D WEATHER_BASE_URL=\\"http://<PC-IP>:8080\\"  bauen, dann:
+
+    python3 tools/weather_stub.py --mode ok
+    python3 tools/weather_stub.py --mode error     # HTTP 500 -> Backoff
+    python3 tools/weather_stub.py --mode slow      # antwortet erst nach 10 s -> Timeout
+    python3 tools/weather_stub.py --mode garbage   # kaputtes JSON -> Parse-Fehler
+"""
+
+import argparse
+import json
+import time
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+RESPONSE = {
+    "weather": [{"id": 500, "main": "Rain", "description": "leichter Regen", "icon": "10d"}],
+    "main": {"temp": 12.34, "feels_like": 11.2, "pressure": 1013, "humidity": 81},
+    "name": "Mannheim",
+    "cod": 200,
+}
+
+
+class Handler(BaseHTTPRequestHandler):
+    mode = "ok"
+
+    def do_GET(self):
+        if not self.path.startswith("/data/2.5/weather"):
+            self.send_error(404)
+            return
+
+        if self.mode == "error":
+            self.send_error(500)
+            return
+
+        if self.mode == "slow":
+            time.sleep(10)
+
+        body = b'{"main":{"temp":' if self.mode == "garbage" else json.dumps(RESPONSE).encode()
+
+        self.send_response(200)
+        self.send_header("Content-Type", "application/json")
+        self.send_header("Content-Length", str(len(body)))
+        self.end_headers()
+        self.wfile.write(body)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--port", type=int, default=8080)
+    parser.add_argument("--mode", choices=["ok", "error", "slow", "garbage"], default="ok")
+    args = parser.parse_args()
+
+    Handler.mode = args.mode
+    print(f"Wetter-Stub auf Port {args.port}, Modus {args.mode}")
+    ThreadingHTTPServer(("", args.port), Handler).serve_forever()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,569 @@
+let sdChart = null;
+let chartData = [];
+let chartChannels = [];
+let nodes = [];
+let currentView = 'alle';
+let currentNode = 'esp32';
+let currentDataset = "temperature";
+let currentRange = 86400;
+let chartCursor = null;     // "next" der letzten /sd-data-Antwort
+let chartRevision = null;   // "rev" dazu; ändert sie sich, gilt der Cursor nicht mehr
+let liveConnected = false;
+let alerts = [];            // Alarm-Regeln mit Stand, wie in /alerts
+let chartStats = null;      // /stats des Nodes im Verlauf
+
+// So viele Punkte liefert der Server je Zeitraum; angehängte Rohwerte dürfen
+// den Verlauf auf das Doppelte wachsen lassen, dann wird neu verdichtet
+const chartPoints = 500;
+
+// Darstellung je Kanal, Schlüssel wie im /sensors-JSON
+const channelInfo = {
+    temperature: { icon: '🌡️', label: 'Temperatur', unit: '°C' },
+    humidity:    { icon: '💧', label: 'Luftfeuchtigkeit', unit: '%' },
+    pressure:    { icon: '🌬️', label: 'Luftdruck', unit: ' hPa' },
+    co2:         { icon: '🫧', label: 'CO₂', unit: ' ppm' },
+    light:       { icon: '💡', label: 'Helligkeit', unit: ' lx' },
+    battery:     { icon: '🔋', label: 'Batterie', unit: ' V' }
+};
+
+const nodeColors = ['#8ab4ff', '#ffb74d', '#81c784', '#f06292', '#ba68c8', '#4dd0e1'];
+
+function zeitAktualisieren() {
+    const jetzt = new Date();
+    const optionen = { 
+        weekday: 'long', 
+        year: 'numeric', 
+        month: 'long', 
+        day: 'numeric'
+    };
+    document.getElementById('zeit').innerHTML =
+        jetzt.toLocaleDateString('de-DE', optionen);
+}
+
+function changeDataset(dataset){
+    currentDataset = dataset;
+    updateChart();
+    showChartStats();
+}
+
+function changeChartNode(node){
+    currentNode = node;
+    chartStats = null;
+    updateChannelSelect();
+    updateSDChart();
+}
+
+function changeRange(range){
+    currentRange = Number(range);
+    updateSDChart();
+}
+
+function setOptions(select, options, selected) {
+    const current = Array.from(select.options).map(o => o.value).join('|');
+    const wanted = options.map(o => o.value).join('|');
+
+    if (current !== wanted) {
+        select.innerHTML = '';
+        options.forEach(o => select.add(new Option(o.label, o.value)));
+    }
+    select.value = selected;
+}
+
+function updateSelects() {
+    const nodeOptions = nodes.map(n => ({ value: n.id, label: n.id }));
+
+    setOptions(document.getElementById('raumAuswahl'),
+        [{ value: 'alle', label: 'Alle Sensoren' }].concat(nodeOptions), currentView);
+    setOptions(document.getElementById('chartNode'), nodeOptions, currentNode);
+    updateChannelSelect();
+}
+
+function updateChannelSelect() {
+    const node = nodes.find(n => n.id === currentNode);
+    const channels = node ? Object.keys(node.values) : [];
+
+    if (channels.length > 0 && !channels.includes(currentDataset)) currentDataset = channels[0];
+
+    setOptions(document.getElementById('chartChannel'),
+        channels.map(c => ({ value: c, label: (channelInfo[c] || { label: c }).label })), currentDataset);
+}
+
+function lastSeenText(lastSeen) {
+    if (!lastSeen) return 'noch keine Daten';
+
+    const minutes = Math.round((Date.now() / 1000 - lastSeen) / 60);
+    return minutes < 1 ? 'gerade eben' : `vor ${minutes} min`;
+}
+
+function renderNodes() {
+    const container = document.getElementById('node-cards');
+    container.innerHTML = '';
+
+    nodes.forEach((node, index) => {
+        if (currentView !== 'alle' && currentView !== node.id) return;
+
+        const title = document.createElement('div');
+        title.className = 'node-title';
+        title.style.color = nodeColors[index % nodeColors.length];
+        title.textContent = `${node.id} · ${lastSeenText(node.last_seen)}`;
+        container.appendChild(title);
+
+        Object.entries(node.values).forEach(([channel, value]) => {
+            const info = channelInfo[channel] || { icon: '📈', label: channel, unit: '' };
+            const card = document.createElement('div');
+            card.className = 'sensor-card';
+            card.innerHTML =
+                `<div class="sensor-icon">${info.icon}</div>` +
+                `<div class="sensor-label">${info.label}</div>` +
+                `<div class="sensor-value"><span>${value.toFixed(1)}</span>${info.unit}</div>`;
+            container.appendChild(card);
+        });
+    });
+}
+
+function showUpdateTime() {
+    const now = new Date();
+    document.getElementById('last-update').textContent =
+        now.toLocaleTimeString('de-DE');
+}
+
+// Neue Messung eines Nodes aus /events übernehmen
+function applySample(sample) {
+    const node = nodes.find(n => n.id === sample.node);
+
+    // Unbekannter Node: einmal die komplette Liste holen
+    if (!node) {
+        updateSensorData();
+        return;
+    }
+
+    const newChannel = Object.keys(sample.values).some(c => !(c in node.values));
+    Object.assign(node.values, sample.values);
+    if (sample.ts > node.last_seen) node.last_seen = sample.ts;
+
+    if (newChannel) updateSelects();
+    renderNodes();
+    showUpdateTime();
+
+    if (sample.node === currentNode) appendChartPoint(sample);
+}
+
+// Punkte hinten anhängen, was aus dem Zeitraum fällt vorne entfernen.
+// Gibt false zurück, wenn nichts Neues dabei war.
+function appendChartPoints(points) {
+    const last = chartData.length ? chartData[chartData.length - 1].ts : 0;
+    points = points.filter(p => p.ts > last);
+    if (points.length === 0) return false;
+
+    const start = Date.now() - currentRange * 1000;
+
+    if (!sdChart) {
+        chartData = chartData.concat(points).filter(p => p.ts >= start);
+        updateChart();
+        return true;
+    }
+
+    const channelIndex = chartChannels.indexOf(currentDataset);
+
+    points.forEach(point => {
+        chartData.push(point);
+        sdChart.data.labels.push(chartLabel(point.ts));
+        sdChart.data.datasets[0].data.push(channelIndex >= 0 ? point.values[channelIndex] : null);
+    });
+
+    while (chartData.length > 1 && chartData[0].ts < start) {
+        chartData.shift();
+        sdChart.data.labels.shift();
+        sdChart.data.datasets[0].data.shift();
+    }
+
+    sdChart.update('none');
+    return true;
+}
+
+function appendChartPoint(sample) {
+    if (!sdChart || chartData.length === 0) return;
+
+    const point = {
+        ts: sample.ts * 1000,
+        values: chartChannels.map(c => c in sample.values ? sample.values[c] : null)
+    };
+    if (appendChartPoints([point])) saveHistory();
+}
+
+// Text eines aktiven Alarms, value je nach Regel Messwert, Änderung pro Stunde oder Sekunden
+function alertText(alert) {
+    const info = channelInfo[alert.channel] || { label: alert.channel, unit: '' };
+    const since = new Date(alert.since * 1000).toLocaleTimeString('de-DE', { hour: '2-digit', minute: '2-digit' });
+
+    switch (alert.type) {
+    case 'above': return `${alert.node}: ${info.label} zu hoch (${alert.value.toFixed(1)}${info.unit}) seit ${since}`;
+    case 'below': return `${alert.node}: ${info.label} zu niedrig (${alert.value.toFixed(1)}${info.unit}) seit ${since}`;
+    case 'rate':  return `${alert.node}: ${info.label} ändert sich schnell (${alert.value.toFixed(1)}${info.unit}/h) seit ${since}`;
+    case 'stale': return `${alert.node}: keine Messung seit ${Math.round(alert.value / 60)} min (${since})`;
+    }
+    return `${alert.node}: ${alert.rule}`;
+}
+
+function renderAlerts() {
+    const container = document.getElementById('alerts');
+    container.innerHTML = '';
+
+    alerts.filter(a => a.active).forEach(alert => {
+        const item = document.createElement('div');
+        item.className = 'alert-item';
+        item.textContent = `⚠️ ${alertText(alert)}`;
+        container.appendChild(item);
+    });
+}
+
+// Wechsel einer Regel aus /events
+function applyAlert(alert) {
+    const index = alerts.findIndex(a => a.rule === alert.rule);
+    if (index >= 0) alerts[index] = alert;
+    else alerts.push(alert);
+    renderAlerts();
+}
+
+function updateAlerts() {
+    fetch('/alerts')
+    .then(response => response.json())
+    .then(data => {
+        alerts = data.alerts || [];
+        renderAlerts();
+    })
+    .catch(error => {
+        console.error('Fehler:', error);
+    });
+}
+
+function connectLive() {
+    if (!window.EventSource) return;
+
+    const source = new EventSource('/events');
+
+    source.addEventListener('open', () => {
+        liveConnected = true;
+        // Nach (Wieder-)Verbindung einmal den vollen Stand holen, im Verlauf nur die Lücke
+        updateSensorData();
+        updateAlerts();
+        if (chartCursor !== null) syncSDChart();
+    });
+
+    source.addEventListener('error', () => {
+        liveConnected = false;
+    });
+
+    source.addEventListener('sample', e => applySample(JSON.parse(e.data)));
+
+    source.addEventListener('alert', e => applyAlert(JSON.parse(e.data)));
+
+    source.addEventListener('weather', e => {
+        document.getElementById('wetter').textContent = JSON.parse(e.data).weather;
+    });
+}
+
+function updateSensorData() {
+    fetch('/sensors')
+    .then(response => response.json())
+    .then(data => {
+
+        nodes = data.nodes || [];
+        updateSelects();
+        renderNodes();
+
+        document.getElementById('wetter').textContent = data.weather;
+
+        showUpdateTime();
+    })
+    .catch(error => {
+        console.error('Fehler:', error);
+    });
+}
+
+// Verlauf je Node und Zeitraum im Browser, damit nach dem Neuladen nur
+// geholt wird, was seitdem dazukam
+function historyKey() {
+    return `sdHistory:${currentNode}:${currentRange}`;
+}
+
+function loadHistory() {
+    try {
+        const stored = JSON.parse(localStorage.getItem(historyKey()));
+        if (stored && Array.isArray(stored.data) && typeof stored.next === 'number') return stored;
+    } catch (e) {
+        // Kaputter Eintrag: wie ohne Speicher
+    }
+    return null;
+}
+
+function saveHistory() {
+    try {
+        localStorage.setItem(historyKey(),
+            JSON.stringify({ next: chartCursor, rev: chartRevision, channels: chartChannels, data: chartData }));
+    } catch (e) {
+        // Speicher voll oder gesperrt: dann eben ohne
+    }
+}
+
+function parseHistory(data) {
+    return (data.data || '').trim().split('\n').filter(line => line).map(line => {
+
+        let parts = line.split(';');
+
+        return {
+            ts: Number(parts[0]) * 1000 || Date.now(),
+            values: parts.slice(1).map(v => v === '' ? null : parseFloat(v))
+        };
+    });
+}
+
+// Fenster aus /stats passend zum Zeitraum des Verlaufs
+const statsWindows = [
+    { range: 86400,  key: 'day',  label: 'Heute' },
+    { range: 604800, key: 'week', label: 'Diese Woche' },
+    { range: Infinity, key: 'all', label: 'Gesamt' }
+];
+
+function showChartStats() {
+    const element = document.getElementById('sdStats');
+    const statsWindow = statsWindows.find(w => currentRange <= w.range);
+    const channels = chartStats && chartStats[statsWindow.key] ? chartStats[statsWindow.key].channels : {};
+    const stats = channels[currentDataset];
+
+    if (!stats) {
+        element.textContent = `${statsWindow.label}: keine Werte`;
+        return;
+    }
+
+    const unit = (channelInfo[currentDataset] || { unit: '' }).unit;
+    element.textContent =
+        `${statsWindow.label}: ⌀ ${stats.mean.toFixed(1)}${unit} · min ${stats.min.toFixed(1)}${unit}` +
+        ` · max ${stats.max.toFixed(1)}${unit} · σ ${Math.sqrt(stats.var).toFixed(2)}${unit}` +
+        ` · ${stats.count} Werte`;
+}
+
+// Min, max, Mittel und Varianz rechnet der Server beim Loggen mit
+function updateStats() {
+    const node = currentNode;
+
+    fetch(`/stats?node=${encodeURIComponent(node)}`)
+    .then(response => response.json())
+    .then(data => {
+        if (node !== currentNode) return;
+        chartStats = data;
+        showChartStats();
+    })
+    .catch(error => {
+        console.error('Fehler:', error);
+    });
+}
+
+// Node oder Zeitraum gewechselt: Gespeichertes sofort zeigen, dann nur Neues holen
+function updateSDChart() {
+    const stored = loadHistory();
+
+    if (!stored) {
+        reloadSDChart();
+        return;
+    }
+
+    const start = Date.now() - currentRange * 1000;
+    chartCursor = stored.next;
+    chartRevision = stored.rev;
+    chartChannels = stored.channels || [];
+    chartData = stored.data.filter(p => p.ts >= start);
+
+    updateStats();
+    updateChart();
+    syncSDChart();
+}
+
+// Ganzen Zeitraum holen, der Server reduziert auf höchstens chartPoints Punkte
+function reloadSDChart() {
+    const node = currentNode;
+    const range = currentRange;
+    const from = Math.floor(Date.now() / 1000) - range;
+
+    fetch(`/sd-data?node=${encodeURIComponent(node)}&from=${from}&points=${chartPoints}&agg=avg`)
+    .then(response => response.json())
+    .then(data => {
+
+        // Inzwischen umgeschaltet: Antwort gehört zu einem anderen Verlauf
+        if (data.status !== 'ok' || node !== currentNode || range !== currentRange) return;
+
+        chartChannels = data.channels || [];
+        chartData = parseHistory(data);
+        chartCursor = data.next;
+        chartRevision = data.rev;
+
+        saveHistory();
+        updateStats();
+        updateChart();
+    })
+    .catch(err => {
+        document.getElementById('sdStats').innerHTML =
+            'SD nicht verfügbar';
+    });
+}
+
+// Nur anhängen, was seit dem Cursor ins Log kam; im Normalfall ein paar Zeilen
+function syncSDChart() {
+    if (chartCursor === null) {
+        reloadSDChart();
+        return;
+    }
+
+    const node = currentNode;
+    const range = currentRange;
+    const since = chartCursor;
+
+    fetch(`/sd-data?node=${encodeURIComponent(node)}&since=${since}&points=${chartPoints}&agg=avg`)
+    .then(response => response.json())
+    .then(data => {
+
+        if (data.status !== 'ok' || node !== currentNode || range !== currentRange) return;
+
+        // Log neu angelegt, Nachlieferungen einsortiert oder Kanäle geändert:
+        // der Cursor passt nicht mehr
+        if (data.next < since || data.rev !== chartRevision
+            || (data.channels || []).join() !== chartChannels.join()) {
+            reloadSDChart();
+            return;
+        }
+
+        chartCursor = data.next;
+        appendChartPoints(parseHistory(data));
+
+        if (chartData.length > 2 * chartPoints) {
+            reloadSDChart();
+            return;
+        }
+
+        saveHistory();
+        updateStats();
+    })
+    .catch(err => {
+        document.getElementById('sdStats').innerHTML =
+            'SD nicht verfügbar';
+    });
+}
+
+function chartLabel(ts) {
+
+    let date = new Date(ts);
+
+    if (currentRange > 86400) {
+        return date.toLocaleString('de-DE', {
+            day: '2-digit',
+            month: '2-digit',
+            hour: '2-digit',
+            minute: '2-digit'
+        });
+    }
+
+    return date.toLocaleTimeString('de-DE', {
+        hour: '2-digit',
+        minute: '2-digit'
+    });
+}
+
+function updateChart() {
+
+    // Firmware ohne Chart.js gebaut: nur die Statistik darunter
+    if (typeof Chart === 'undefined') {
+        document.getElementById('sdChart').style.display = 'none';
+        return;
+    }
+
+    const ctx = document.getElementById('sdChart').getContext('2d');
+
+    if (sdChart) sdChart.destroy();
+
+    if (chartData.length === 0) return;
+
+    const channelIndex = chartChannels.indexOf(currentDataset);
+
+    let values = chartData.map(d => channelIndex >= 0 ? d.values[channelIndex] : null);
+
+    let labels = chartData.map(d => chartLabel(d.ts));
+
+    sdChart = new Chart(ctx, {
+
+        type: 'line',
+
+        data: {
+
+            labels: labels,
+
+            datasets: [{
+
+                label: `${currentNode} ${currentDataset}`,
+                data: values,
+
+                borderColor: '#ff6384',
+                backgroundColor: 'rgba(255,99,132,0.1)',
+
+                tension: 0.4,
+                fill: true,
+                pointRadius: 0,
+                borderWidth: 3,
+                spanGaps: true
+            }]
+        },
+
+        options: {
+
+            responsive: true,
+            maintainAspectRatio: false,
+
+            plugins: {
+
+                legend: {
+                    display: false
+                }
+            },
+
+            scales: {
+
+                x: {
+                    ticks: { color: '#ccc', maxTicksLimit: 10 },
+                    grid: { color: 'rgba(255,255,255,0.1)' }
+                },
+
+                y: {
+                    ticks: { color: '#ccc' },
+                    grid: { color: 'rgba(255,255,255,0.1)' }
+                }
+            }
+        }
+    });
+}
+
+function changeSensorView(view) {
+
+    currentView = view;
+
+    document.getElementById('raumAuswahl').value = view;
+
+    renderNodes();
+}
+
+window.onload = function() {
+
+    zeitAktualisieren();
+    updateSensorData();
+    updateAlerts();
+    updateSDChart();
+    connectLive();
+
+    setInterval(zeitAktualisieren, 60000);
+
+    // Neue Werte kommen über /events; abgefragt wird nur ohne Verbindung
+    setInterval(() => { if (!liveConnected) { updateSensorData(); updateAlerts(); } }, 60000);
+
+    // Verlauf: ohne Verbindung jede Minute nachholen, mit Verbindung nur
+    // gelegentlich zum Abgleich - in beiden Fällen nur seit dem Cursor
+    setInterval(() => { if (!liveConnected) syncSDChart(); }, 60000);
+    setInterval(syncSDChart, 15 * 60000);
+}